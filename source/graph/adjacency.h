@@ -0,0 +1,348 @@
+#ifndef GRAPH_ADJACENCY_H
+#define GRAPH_ADJACENCY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+#include "hash_index.h"
+#include "small_vector.h"
+
+
+/*!
+    \brief Полуребро - запись в списке смежности вершины.
+    \details Вершина, из которой выходит полуребро, определяется списком, в котором оно лежит, поэтому не хранится.
+    Объект Edge собирается из полуребра только на границе API (AllEdges, WriteTo).
+    * to - внутренний индекс соседней вершины
+    * weight - вес ребра
+*/
+template <class Weight>
+struct HalfEdge {
+    uint32_t to;
+    Weight weight;
+};
+
+/*!
+    \brief Полуребро невзвешенного графа: вес не хранится вовсе, полуребро занимает 4 байта
+*/
+template <>
+struct HalfEdge<void> {
+    uint32_t to;
+};
+
+/*!
+ * Поиск первого полуребра с соседом не меньше to в упорядоченном по соседу отрезке.
+ * Сначала границы отрезка удваиваются от начала, затем внутри найденного отрезка выполняется двоичный поиск,
+ * поэтому поиск близкого к началу соседа стоит O(log pos), а не O(log n)
+ */
+template <class Half>
+const Half* GallopLowerBound(const Half* first, const Half* last, uint32_t to) {
+    size_t n = last - first;
+    if (n == 0) {
+        return first;
+    }
+    size_t bound = 1;
+    while (bound < n && first[bound].to < to) {
+        bound <<= 1;
+    }
+    return std::lower_bound(first + bound / 2, first + std::min(bound + 1, n), to, [](const Half& half, uint32_t key) {
+        return half.to < key;
+    });
+}
+
+/*!
+    \brief Класс AdjacencyList - список смежности одной вершины, подстраивающийся под ее степень.
+    \details Пока степень не больше порога, полуребра хранятся упорядоченными по соседу, и поиск - это галопирующий
+    двоичный поиск, а вставка и удаление сдвигают хвост списка. Когда степень превышает порог, вершина становится
+    "хабом": порядок полуребер больше не поддерживается, рядом заводится хеш-индекс сосед -> позиция, и вставка,
+    поиск и удаление (обменом с последним) выполняются за O(1) в среднем. Обратно в упорядоченный вид список
+    переходит, когда степень опускается ниже половины порога.
+    Первые kInlineHalfEdges полуребер лежат прямо в объекте списка, так что у вершин малой степени список смежности
+    не обращается к куче, а весь объект занимает одну кэш-линию.
+    Список поддерживает соглашения std::pmr об аллокаторах: полуребра и хеш-индекс хаба выделяются из memory_resource,
+    который передал контейнер, например std::pmr::vector<AdjacencyList> графа.
+    Weight - тип веса ребра, void для невзвешенного графа.
+    * half_edges - полуребра
+    * hub - индекс сосед -> позиция, есть только у хабов; выделяется из того же memory_resource, что и полуребра
+*/
+template <class Weight>
+class AdjacencyList {
+public:
+    using Half = HalfEdge<Weight>;
+    using allocator_type = std::pmr::polymorphic_allocator<Half>;
+
+    // сколько полуребер помещается в объект списка, чтобы он вместе с указателями на хеш-индекс и memory_resource
+    // занимал 64 байта
+    static constexpr uint32_t kInlineHalfEdges = (64 - 2 * sizeof(uint32_t) - 2 * sizeof(void*)) / sizeof(Half);
+
+    AdjacencyList() = default;
+    explicit AdjacencyList(const allocator_type& alloc) : half_edges(alloc.resource()) {}
+    AdjacencyList(const AdjacencyList& other, const allocator_type& alloc = {}) : half_edges(other.half_edges, alloc.resource()) {
+        if (other.hub) {
+            this->hub = this->newHub(*other.hub);
+        }
+    }
+    AdjacencyList(AdjacencyList&& other) noexcept : half_edges(std::move(other.half_edges)), hub(other.hub) {
+        other.hub = nullptr;
+    }
+    AdjacencyList(AdjacencyList&& other, const allocator_type& alloc) : half_edges(alloc.resource()) {
+        this->moveFrom(other);
+    }
+    AdjacencyList& operator=(const AdjacencyList& other) {
+        if (this != &other) {
+            *this = AdjacencyList(other, allocator_type(this->Resource()));
+        }
+        return *this;
+    }
+    AdjacencyList& operator=(AdjacencyList&& other) {
+        if (this != &other) {
+            this->dropHub();
+            this->moveFrom(other);
+        }
+        return *this;
+    }
+    ~AdjacencyList() {
+        this->dropHub();
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(this->Resource());
+    }
+    std::pmr::memory_resource* Resource() const noexcept {
+        return this->half_edges.Resource();
+    }
+
+    size_t size() const noexcept {
+        return this->half_edges.size();
+    }
+    bool empty() const noexcept {
+        return this->half_edges.empty();
+    }
+    const Half* begin() const noexcept {
+        return this->half_edges.data();
+    }
+    const Half* end() const noexcept {
+        return this->half_edges.data() + this->half_edges.size();
+    }
+    const Half& operator[](size_t pos) const noexcept {
+        return this->half_edges[pos];
+    }
+    bool IsHub() const noexcept {
+        return this->hub != nullptr;
+    }
+
+    void Reserve(size_t n) {
+        this->half_edges.Reserve(n);
+    }
+
+    /*!
+     * Поиск полуребра к соседу
+     * @param to внутренний индекс соседа
+     * @return Позиция полуребра в списке или -1, если его нет
+     */
+    int Find(uint32_t to) const noexcept {
+        if (this->hub) {
+            uint32_t pos = this->hub->Find(to);
+            return pos == HashIndex<uint32_t>::kNotFound ? -1 : static_cast<int>(pos);
+        }
+        const Half* it = GallopLowerBound(this->begin(), this->end(), to);
+        return (it != this->end() && it->to == to) ? static_cast<int>(it - this->begin()) : -1;
+    }
+
+    /*!
+     * Вставляет полуребро, сохраняя порядок (или хеш-индекс у хаба)
+     * @param threshold порог степени, после которого список становится хабом
+     * @return Позиция вставленного полуребра
+     */
+    size_t Insert(Half half, size_t threshold) {
+        if (this->hub) {
+            this->hub->Assign(half.to, this->half_edges.size());
+            this->half_edges.push_back(half);
+            return this->half_edges.size() - 1;
+        }
+        size_t pos = GallopLowerBound(this->begin(), this->end(), half.to) - this->begin();
+        this->half_edges.insert(this->half_edges.begin() + pos, half);
+        if (this->half_edges.size() > threshold) {
+            this->makeHub();
+        }
+        return pos;
+    }
+
+    /*!
+     * Удаляет полуребро на позиции pos
+     * @param threshold порог степени, после которого список становится хабом
+     */
+    void Erase(size_t pos, size_t threshold) {
+        if (this->hub) {
+            this->hub->Erase(this->half_edges[pos].to);
+            if (pos + 1 != this->half_edges.size()) {
+                this->half_edges[pos] = this->half_edges.back();
+                this->hub->Assign(this->half_edges[pos].to, pos);
+            }
+            this->half_edges.pop_back();
+            if (this->half_edges.size() < threshold / 2) {
+                this->makeSorted();
+            }
+            return;
+        }
+        this->half_edges.erase(this->half_edges.begin() + pos);
+    }
+
+    /*!
+     * Меняет соседа у полуребра на позиции pos (используется при перенумерации вершин)
+     * @param threshold порог степени, после которого список становится хабом
+     */
+    void Relabel(size_t pos, uint32_t to, size_t threshold) {
+        Half half = this->half_edges[pos];
+        if (this->hub) {
+            this->hub->Erase(half.to);
+            this->half_edges[pos].to = to;
+            this->hub->Assign(to, pos);
+            return;
+        }
+        this->Erase(pos, threshold);
+        half.to = to;
+        this->Insert(half, threshold);
+    }
+
+    /*!
+     * Меняет вес полуребра на позиции pos; порядок списка от веса не зависит, поэтому полуребро остается на месте
+     */
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    void SetWeight(size_t pos, const W& weight) {
+        this->half_edges[pos].weight = weight;
+    }
+
+    /*!
+     * Добавляет полуребро в конец, не поддерживая порядок; после серии таких вставок нужно вызвать Normalize
+     */
+    void PushBackUnordered(Half half) {
+        this->half_edges.push_back(half);
+    }
+
+    /*!
+     * Восстанавливает порядок (или хеш-индекс) после вставок PushBackUnordered
+     * @param old_size размер списка до вставок: первые old_size полуребер уже упорядочены
+     * @param threshold порог степени, после которого список становится хабом
+     * @note Устойчиво: полуребра с одинаковым соседом остаются в порядке вставки
+     */
+    void Normalize(size_t old_size, size_t threshold) {
+        if (this->hub) {
+            for (size_t pos = old_size; pos < this->half_edges.size(); pos++) {
+                this->hub->Assign(this->half_edges[pos].to, pos);
+            }
+            return;
+        }
+        auto by_to = [](const Half& a, const Half& b) {
+            return a.to < b.to;
+        };
+        auto middle = this->half_edges.begin() + old_size;
+        std::stable_sort(middle, this->half_edges.end(), by_to);
+        std::inplace_merge(this->half_edges.begin(), middle, this->half_edges.end(), by_to);
+        if (this->half_edges.size() > threshold) {
+            this->makeHub();
+        }
+    }
+
+    /*!
+     * Удаляет все полуребра, для которых pred вернул true, сохраняя порядок остальных
+     * @param threshold порог степени, после которого список становится хабом
+     */
+    template <class Pred>
+    void RemoveIf(Pred pred, size_t threshold) {
+        this->half_edges.erase(std::remove_if(this->half_edges.begin(), this->half_edges.end(), pred), this->half_edges.end());
+        this->half_edges.ShrinkToFit();
+        if (this->hub) {
+            this->dropHub();
+            if (this->half_edges.size() < threshold / 2) {
+                this->makeSorted();
+            } else {
+                this->makeHub();
+            }
+        }
+    }
+
+    /*!
+     * Заменяет соседа у каждого полуребра на relabel(to) и восстанавливает порядок
+     * @param threshold порог степени, после которого список становится хабом
+     */
+    template <class Relabel>
+    void RelabelAll(Relabel relabel, size_t threshold) {
+        for (auto& half : this->half_edges) {
+            half.to = relabel(half.to);
+        }
+        this->dropHub();
+        this->makeSorted();
+        if (this->half_edges.size() > threshold) {
+            this->makeHub();
+        }
+    }
+
+    /*!
+     * Приводит список к виду, соответствующему новому порогу
+     * @param threshold порог степени, после которого список становится хабом
+     */
+    void Rebalance(size_t threshold) {
+        if (this->hub && this->half_edges.size() <= threshold) {
+            this->makeSorted();
+        } else if (!this->hub && this->half_edges.size() > threshold) {
+            this->makeHub();
+        }
+    }
+
+private:
+    template <class... Args>
+    HashIndex<uint32_t>* newHub(Args&&... args) {
+        void* place = this->Resource()->allocate(sizeof(HashIndex<uint32_t>), alignof(HashIndex<uint32_t>));
+        try {
+            return new (place) HashIndex<uint32_t>(std::forward<Args>(args)..., this->Resource());
+        } catch (...) {
+            this->Resource()->deallocate(place, sizeof(HashIndex<uint32_t>), alignof(HashIndex<uint32_t>));
+            throw;
+        }
+    }
+
+    void dropHub() noexcept {
+        if (this->hub) {
+            this->hub->~HashIndex();
+            this->Resource()->deallocate(this->hub, sizeof(HashIndex<uint32_t>), alignof(HashIndex<uint32_t>));
+            this->hub = nullptr;
+        }
+    }
+
+    // хеш-индекс можно забрать, только если он выделен из того же ресурса, иначе он строится заново
+    void moveFrom(AdjacencyList& other) {
+        bool same_resource = this->Resource()->is_equal(*other.Resource());
+        this->half_edges = std::move(other.half_edges);
+        if (other.hub && same_resource) {
+            this->hub = other.hub;
+            other.hub = nullptr;
+        } else if (other.hub) {
+            other.dropHub();
+            this->makeHub();
+        }
+    }
+
+    void makeHub() {
+        this->dropHub();
+        this->hub = this->newHub();
+        this->hub->Reserve(this->half_edges.size());
+        for (size_t pos = 0; pos < this->half_edges.size(); pos++) {
+            this->hub->Assign(this->half_edges[pos].to, pos);
+        }
+    }
+
+    void makeSorted() {
+        this->dropHub();
+        std::sort(this->half_edges.begin(), this->half_edges.end(), [](const Half& a, const Half& b) {
+            return a.to < b.to;
+        });
+    }
+
+    detail::SmallVector<Half, kInlineHalfEdges> half_edges;
+    HashIndex<uint32_t>* hub = nullptr;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef GRAPH_ARENA_H
+#define GRAPH_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+#include "adjacency.h"
+
+
+/*!
+    \brief Класс GraphArena - монотонная арена для временных графов.
+    \details Память выдается подряд из больших блоков, освобождение отдельных блоков ничего не делает, а все блоки
+    возвращаются разом в деструкторе арены или в Release. Подходит для графов, которые строятся, читаются и
+    выбрасываются целиком, например для результата FindMST: разрушение такого графа не обходит миллионы блоков.
+    В отличие от std::pmr::monotonic_buffer_resource, арену можно использовать из нескольких потоков, поэтому
+    пакетные операции графа заполняют списки смежности параллельно и на ней.
+    * arena - сама монотонная арена
+    * mutex - защищает арену при параллельных выделениях
+*/
+class GraphArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kDefaultBlockSize = size_t(1) << 20;
+
+    /*!
+     * @param block_size размер первого блока арены в байтах, следующие блоки растут геометрически
+     * @param upstream откуда арена берет блоки
+     */
+    explicit GraphArena(size_t block_size = kDefaultBlockSize,
+                        std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : arena(block_size, upstream) {}
+
+    /*!
+     * Возвращает все блоки арены. Все объекты, память которых выделена из арены, должны быть уже разрушены
+     */
+    void Release() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->arena.release();
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->arena.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::mutex mutex;
+};
+
+/*!
+    \brief Класс AdjacencyPool - пул блоков, настроенный под списки смежности.
+    \details Списки смежности, вышедшие из встроенного буфера, растут удвоением, поэтому их блоки бывают лишь
+    нескольких размеров: пул держит для каждого размера до kLargestPooledHalfEdges полуребер свой список свободных
+    блоков и нарезает их из больших кусков, а освобожденный блок сразу уходит следующему списку того же размера.
+    Списки большей степени (как правило, хабы) обращаются к upstream напрямую. Размеры рассчитаны на полуребра
+    Graph с весом int; у графов с более широкими весами в пул попадают списки соответственно меньшей степени.
+    Пул синхронизирован, поэтому пакетные операции графа работают на нем параллельно.
+*/
+class AdjacencyPool : public std::pmr::synchronized_pool_resource {
+public:
+    static constexpr size_t kLargestPooledHalfEdges = 512;
+    static constexpr size_t kBlocksPerChunk = 256;
+
+    explicit AdjacencyPool(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : std::pmr::synchronized_pool_resource(Options(), upstream) {}
+
+    static std::pmr::pool_options Options() {
+        std::pmr::pool_options options;
+        options.max_blocks_per_chunk = kBlocksPerChunk;
+        options.largest_required_pool_block = kLargestPooledHalfEdges * sizeof(HalfEdge<int>);
+        return options;
+    }
+};
+
+namespace detail {
+
+/*!
+ * Можно ли выделять память из resource одновременно из нескольких потоков
+ * @note Распознаются только стандартный new/delete, синхронизированные пулы и GraphArena; для остальных ресурсов
+ * граф изменяет списки смежности в одном потоке
+ */
+inline bool IsConcurrentResource(const std::pmr::memory_resource* resource) {
+    return resource == std::pmr::new_delete_resource() ||
+           dynamic_cast<const std::pmr::synchronized_pool_resource*>(resource) != nullptr ||
+           dynamic_cast<const GraphArena*>(resource) != nullptr;
+}
+
+}
+
+#endif
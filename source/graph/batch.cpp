@@ -0,0 +1,389 @@
+#include "graph.h"
+
+#include "arena.h"
+#include "parallel.h"
+#include "radix_sort.h"
+
+namespace {
+
+// количество бит, достаточное для записи любого индекса вершины из [0, n)
+unsigned IndexBits(size_t n) {
+    unsigned bits = 1;
+    while (bits < 32 && (size_t(1) << bits) < n) {
+        bits++;
+    }
+    return bits;
+}
+
+/*!
+ * Устойчиво группирует записи по потокам: поток part отвечает за вершины [n * part / threads, n * (part + 1) / threads)
+ * @param vertex_of функция, возвращающая вершину, к которой относится запись
+ * @return Границы групп: записи потока part лежат в [bounds[part], bounds[part + 1])
+ * @note Это один проход поразрядной сортировки по номеру потока: параллельная гистограмма и параллельная раскладка
+ */
+template <class Record, class VertexOf>
+std::vector<size_t> GroupByOwner(std::vector<Record>& records, size_t n, size_t threads, VertexOf vertex_of) {
+    std::vector<size_t> bounds(threads + 1, 0);
+    bounds[threads] = records.size();
+    if (threads == 1) {
+        return bounds;
+    }
+
+    auto owner = [&](uint32_t v) {
+        return static_cast<size_t>(((uint64_t(v) + 1) * threads - 1) / n);
+    };
+    std::vector<size_t> count(threads * threads, 0);
+    detail::ParallelChunks(0, records.size(), threads, [&](size_t part, size_t lo, size_t hi) {
+        for (size_t k = lo; k < hi; k++) {
+            count[part * threads + owner(vertex_of(records[k]))]++;
+        }
+    });
+    size_t sum = 0;
+    for (size_t o = 0; o < threads; o++) {
+        bounds[o] = sum;
+        for (size_t part = 0; part < threads; part++) {
+            size_t c = count[part * threads + o];
+            count[part * threads + o] = sum;
+            sum += c;
+        }
+    }
+
+    std::vector<Record> grouped(records.size());
+    detail::ParallelChunks(0, records.size(), threads, [&](size_t part, size_t lo, size_t hi) {
+        for (size_t k = lo; k < hi; k++) {
+            grouped[count[part * threads + owner(vertex_of(records[k]))]++] = records[k];
+        }
+    });
+    records.swap(grouped);
+    return bounds;
+}
+
+/*!
+ * Параллельно обходит ключи, отсортированные по старшим 32 битам (индексу вершины), сериями одной вершины
+ * @param grain минимальное количество ключей на поток
+ * @param f вызывается как f(v, first, last) для каждой серии; серия целиком достается одному потоку,
+ * поэтому разные потоки меняют разные списки смежности
+ */
+template <class F>
+void ForEachVertexRun(const std::vector<uint64_t>& keys, size_t grain, F&& f) {
+    auto align = [&](size_t pos) {
+        while (pos > 0 && pos < keys.size() && (keys[pos] >> 32) == (keys[pos - 1] >> 32)) {
+            pos++;
+        }
+        return pos;
+    };
+    detail::ParallelFor(0, keys.size(), [&](size_t lo, size_t hi) {
+        lo = align(lo);
+        hi = align(hi);
+        while (lo < hi) {
+            size_t run = lo;
+            while (run < hi && (keys[run] >> 32) == (keys[lo] >> 32)) {
+                run++;
+            }
+            f(static_cast<uint32_t>(keys[lo] >> 32), keys.data() + lo, keys.data() + run);
+            lo = run;
+        }
+    }, grain);
+}
+
+}
+
+template <class VertexId, class Weight>
+std::vector<uint32_t> BasicGraph<VertexId, Weight>::findEnds(const std::vector<Edge>& edges) const {
+    if (edges.size() * 2 > UINT32_MAX) {
+        throw Exceptions("Слишком много ребер\n");
+    }
+    std::vector<uint32_t> ends(edges.size() * 2);
+    detail::ParallelFor(0, edges.size(), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            ends[2 * i] = this->vertex_index->Find(edges[i].from_vertex);
+            ends[2 * i + 1] = this->vertex_index->Find(edges[i].other_vertex);
+        }
+    });
+    return ends;
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::appendEdges(const std::vector<uint32_t>& ends, const std::vector<Edge>& edges, size_t threshold) {
+    size_t n = this->vertex->size();
+    size_t threads = std::min(detail::ThreadCount(ends.size(), this->listGrain(detail::kParallelGrain)), std::max<size_t>(n, 1));
+    // петля хранится одним полуребром, поэтому второе полуребро петли пропускаем
+    std::vector<uint32_t> halves;
+    halves.reserve(ends.size());
+    for (size_t h = 0; h < ends.size(); h++) {
+        if ((h & 1) == 0 || ends[h] != ends[h ^ 1]) {
+            halves.push_back(h);
+            // списки дальше меняются параллельно, поэтому куски, которые они делят с копиями графа, отделяем заранее
+            this->edge.Unshare(ends[h]);
+        }
+    }
+    std::vector<size_t> bounds = GroupByOwner(halves, n, threads, [&](uint32_t h) {
+        return ends[h];
+    });
+
+    detail::ParallelChunks(0, threads, threads, [&](size_t part, size_t, size_t) {
+        size_t lo = n * part / threads;
+        size_t hi = n * (part + 1) / threads;
+        uint32_t* first = halves.data() + bounds[part];
+        uint32_t* last = halves.data() + bounds[part + 1];
+        auto push = [&](uint32_t h) {
+            this->edge.Mutable(ends[h]).PushBackUnordered(makeHalf(ends[h ^ 1], edges[h / 2]));
+        };
+
+        if (size_t(last - first) * 4 >= hi - lo) {
+            // большая пачка: считаем степени в массиве на весь отрезок вершин
+            std::vector<uint32_t> degree(hi - lo, 0);
+            for (uint32_t* it = first; it != last; it++) {
+                degree[ends[*it] - lo]++;
+            }
+            for (size_t v = lo; v < hi; v++) {
+                if (degree[v - lo] != 0) {
+                    this->edge.Mutable(v).Reserve(this->edge[v].size() + degree[v - lo]);
+                }
+            }
+            std::for_each(first, last, push);
+            for (size_t v = lo; v < hi; v++) {
+                if (degree[v - lo] != 0) {
+                    this->edge.Mutable(v).Normalize(this->edge[v].size() - degree[v - lo], threshold);
+                }
+            }
+        } else {
+            // маленькая пачка: группируем ее полуребра по вершине, не заводя массив на весь отрезок
+            std::stable_sort(first, last, [&](uint32_t a, uint32_t b) {
+                return ends[a] < ends[b];
+            });
+            for (uint32_t* run = first; run != last;) {
+                uint32_t* run_end = run;
+                while (run_end != last && ends[*run_end] == ends[*run]) {
+                    run_end++;
+                }
+                List& list = this->edge.Mutable(ends[*run]);
+                size_t old_size = list.size();
+                list.Reserve(old_size + (run_end - run));
+                std::for_each(run, run_end, push);
+                list.Normalize(old_size, threshold);
+                run = run_end;
+            }
+        }
+    });
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::AddEdges(const std::vector<Edge>& edges) {
+    std::vector<uint32_t> ends = this->findEnds(edges);
+
+    // проверяем всю пачку до того, как что-то менять
+    detail::ParallelFor(0, edges.size(), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            if (ends[2 * i] == HashIndex<VertexId>::kNotFound || ends[2 * i + 1] == HashIndex<VertexId>::kNotFound) {
+                throw Exceptions("Вершины нет в графе\n");
+            }
+            if (this->findEdge(ends[2 * i], ends[2 * i + 1]) != -1) {
+                throw Exceptions("Ребро уже есть в графе\n");
+            }
+        }
+    });
+    std::vector<uint64_t> pairs(edges.size());
+    for (size_t i = 0; i < edges.size(); i++) {
+        uint64_t v1 = std::min(ends[2 * i], ends[2 * i + 1]);
+        uint64_t v2 = std::max(ends[2 * i], ends[2 * i + 1]);
+        pairs[i] = (v1 << 32) | v2;
+    }
+    detail::RadixSort(pairs);
+    if (std::adjacent_find(pairs.begin(), pairs.end()) != pairs.end()) {
+        throw Exceptions("Ребро уже есть в графе\n");
+    }
+
+    this->appendEdges(ends, edges, this->hub_threshold);
+    for (size_t i = 0; i < edges.size(); i++) {
+        this->indexEdge(ends[2 * i], ends[2 * i + 1], makeHalf(ends[2 * i + 1], edges[i]));
+    }
+    if (detail::Properties* props = this->edgeProperties()) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            props->PushEdge(ends[2 * i], ends[2 * i + 1]);
+        }
+    }
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::RemoveEdges(const std::vector<Edge>& edges) {
+    std::vector<uint32_t> ends = this->findEnds(edges);
+
+    // проверяем всю пачку до того, как что-то менять; одно и то же ребро нельзя удалить дважды
+    detail::ParallelFor(0, edges.size(), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            if (ends[2 * i] == HashIndex<VertexId>::kNotFound || ends[2 * i + 1] == HashIndex<VertexId>::kNotFound ||
+                this->findEdge(ends[2 * i], ends[2 * i + 1]) == -1) {
+                throw Exceptions("Ребра нет в графе\n");
+            }
+        }
+    });
+    std::vector<uint64_t> pairs(edges.size());
+    for (size_t i = 0; i < edges.size(); i++) {
+        uint64_t v1 = std::min(ends[2 * i], ends[2 * i + 1]);
+        uint64_t v2 = std::max(ends[2 * i], ends[2 * i + 1]);
+        pairs[i] = (v1 << 32) | v2;
+    }
+    detail::RadixSort(pairs);
+    if (std::adjacent_find(pairs.begin(), pairs.end()) != pairs.end()) {
+        throw Exceptions("Ребра нет в графе\n");
+    }
+    if constexpr (!std::is_void_v<Weight>) {
+        if (this->weight_index.Exclusive()) {
+            // вес удаляемого ребра знает только граф, в пачке он не учитывается; разделяемый индекс Exclusive уже
+            // отпустил, тогда ребра здесь не ищутся
+            for (size_t i = 0; i < edges.size(); i++) {
+                this->unindexEdge(ends[2 * i], ends[2 * i + 1], this->edge[ends[2 * i]][this->findEdge(ends[2 * i], ends[2 * i + 1])]);
+            }
+        }
+    }
+    if (detail::Properties* props = this->edgeProperties()) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            props->EraseEdge(ends[2 * i], ends[2 * i + 1]);
+        }
+    }
+
+    // ключ (вершина, сосед) для каждого полуребра, которое нужно убрать
+    std::vector<uint64_t> keys(ends.size());
+    for (size_t h = 0; h < ends.size(); h++) {
+        keys[h] = (uint64_t(ends[h]) << 32) | ends[h ^ 1];
+    }
+    unsigned bits = IndexBits(this->vertex->size());
+    detail::RadixSort(keys, 0, 32 + bits);
+    for (uint32_t v : ends) {
+        this->edge.Unshare(v);
+    }
+
+    // каждый затронутый список фильтруется один раз, порядок оставшихся полуребер сохраняется
+    ForEachVertexRun(keys, this->listGrain(detail::kParallelGrain), [&](uint32_t v, const uint64_t* first, const uint64_t* last) {
+        this->edge.Mutable(v).RemoveIf([&](const Half& half) {
+            return std::binary_search(first, last, (uint64_t(v) << 32) | half.to);
+        }, this->hub_threshold);
+    });
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::RemoveVertices(const std::vector<VertexId>& vertices) {
+    std::vector<uint32_t> removed(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        removed[i] = this->vertex_index->Find(vertices[i]);
+        if (removed[i] == HashIndex<VertexId>::kNotFound) {
+            throw Exceptions("Вершина нет в графе\n");
+        }
+    }
+    std::sort(removed.begin(), removed.end());
+    if (std::adjacent_find(removed.begin(), removed.end()) != removed.end()) {
+        throw Exceptions("Вершина нет в графе\n");
+    }
+    auto is_removed = [&](uint32_t v) {
+        return std::binary_search(removed.begin(), removed.end(), v);
+    };
+    unsigned bits = IndexBits(this->vertex->size());
+
+    // 1. убираем у оставшихся соседей полуребра, ведущие в удаляемые вершины
+    std::vector<uint64_t> keys;
+    detail::Properties* edge_props = this->edgeProperties();
+    for (uint32_t r : removed) {
+        for (auto& half : this->edge[r]) {
+            // ребро между двумя удаляемыми вершинами убирается из индекса весов и таблицы слотов дважды,
+            // второй раз ничего не делает
+            this->unindexEdge(r, half.to, half);
+            if (edge_props) {
+                edge_props->EraseEdge(r, half.to);
+            }
+            if (!is_removed(half.to)) {
+                keys.push_back((uint64_t(half.to) << 32) | r);
+            }
+        }
+    }
+    detail::RadixSort(keys, 0, 32 + bits);
+    for (uint64_t key : keys) {
+        this->edge.Unshare(key >> 32);
+    }
+    ForEachVertexRun(keys, this->listGrain(detail::kParallelGrain), [&](uint32_t v, const uint64_t* first, const uint64_t* last) {
+        this->edge.Mutable(v).RemoveIf([&](const Half& half) {
+            return std::binary_search(first, last, (uint64_t(v) << 32) | half.to);
+        }, this->hub_threshold);
+    });
+
+    // 2. заполняем дыры среди первых new_size мест вершинами с хвоста: переезжает не больше вершин, чем удаляется
+    std::pmr::vector<VertexId>& ids = this->vertex.Mutable();
+    HashIndex<VertexId>& index = this->vertex_index.Mutable();
+    size_t new_size = ids.size() - removed.size();
+    for (uint32_t r : removed) {
+        index.Erase(ids[r]);
+    }
+    HashIndex<uint32_t> moved;
+    std::vector<uint32_t> holes;
+    std::vector<uint32_t> origins;
+    detail::Properties* props = this->vertexProperties();
+    auto hole = removed.begin();
+    for (uint32_t v = new_size; v < ids.size(); v++) {
+        if (is_removed(v)) {
+            continue;
+        }
+        if (props) {
+            props->MoveVertex(v, *hole);
+        }
+        this->edge.Mutable(*hole) = std::move(this->edge.Mutable(v));
+        ids[*hole] = ids[v];
+        index.Assign(ids[*hole], *hole);
+        moved.Assign(v, *hole);
+        holes.push_back(*hole);
+        origins.push_back(v);
+        hole++;
+    }
+    this->edge.resize(new_size);
+    ids.resize(new_size);
+    this->vertex_order.Reset();
+    if (props) {
+        props->TruncateVertices(new_size);
+    }
+    if (edge_props) {
+        // ключи ребер переехавших вершин меняются на новые индексы концов; ребро между двумя переехавшими
+        // вершинами меняет ключ один раз, со стороны конца с меньшим старым индексом
+        for (size_t k = 0; k < holes.size(); k++) {
+            for (auto& half : this->edge[holes[k]]) {
+                uint32_t to = moved.Find(half.to);
+                if (to != HashIndex<uint32_t>::kNotFound && half.to < origins[k]) {
+                    continue;
+                }
+                edge_props->RekeyEdge(detail::Properties::EdgeKey(origins[k], half.to),
+                                      detail::Properties::EdgeKey(holes[k], to == HashIndex<uint32_t>::kNotFound ? half.to : to));
+            }
+        }
+    }
+
+    // 3. перенумеровываем полуребра, указывающие на переехавшие вершины: они лежат в списках самих
+    // переехавших вершин и их соседей, каждый такой список обходится один раз
+    std::vector<uint32_t> affected;
+    for (uint32_t h : holes) {
+        affected.push_back(h);
+        for (auto& half : this->edge[h]) {
+            uint32_t to = moved.Find(half.to);
+            affected.push_back(to == HashIndex<uint32_t>::kNotFound ? half.to : to);
+        }
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+    for (uint32_t v : affected) {
+        this->edge.Unshare(v);
+    }
+    detail::ParallelFor(0, affected.size(), [&](size_t lo, size_t hi) {
+        for (size_t k = lo; k < hi; k++) {
+            this->edge.Mutable(affected[k]).RelabelAll([&](uint32_t v) {
+                uint32_t to = moved.Find(v);
+                return to == HashIndex<uint32_t>::kNotFound ? v : to;
+            }, this->hub_threshold);
+        }
+    }, this->listGrain(256));
+}
+
+#define INSTANTIATE(VertexId, Weight) \
+    template std::vector<uint32_t> BasicGraph<VertexId, Weight>::findEnds(const std::vector<Edge>&) const; \
+    template void BasicGraph<VertexId, Weight>::appendEdges(const std::vector<uint32_t>&, const std::vector<Edge>&, size_t); \
+    template void BasicGraph<VertexId, Weight>::AddEdges(const std::vector<Edge>&); \
+    template void BasicGraph<VertexId, Weight>::RemoveEdges(const std::vector<Edge>&); \
+    template void BasicGraph<VertexId, Weight>::RemoveVertices(const std::vector<VertexId>&);
+GRAPH_FOR_EACH_INSTANCE(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,421 @@
+#ifndef GRAPH_COW_H
+#define GRAPH_COW_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace detail {
+
+/*!
+ * Создает объект T в памяти из resource; блок управления shared_ptr тоже берется из resource
+ * @param resource источник памяти; должен жить дольше последнего владельца объекта
+ * @param args аргументы конструктора T
+ * @return Владеющий указатель на новый объект
+ */
+template <class T, class... Args>
+std::shared_ptr<T> MakeShared(std::pmr::memory_resource* resource, Args&&... args) {
+    void* place = resource->allocate(sizeof(T), alignof(T));
+    T* object;
+    try {
+        object = new (place) T(std::forward<Args>(args)...);
+    } catch (...) {
+        resource->deallocate(place, sizeof(T), alignof(T));
+        throw;
+    }
+    auto destroy = [resource](T* ptr) {
+        ptr->~T();
+        resource->deallocate(ptr, sizeof(T), alignof(T));
+    };
+    return std::shared_ptr<T>(object, destroy, std::pmr::polymorphic_allocator<T>(resource));
+}
+
+// владелец, который может менять объект: если кроме него объект никто не держит, копировать не нужно
+template <class T>
+bool IsUnique(const std::shared_ptr<T>& ptr) {
+    if (ptr.use_count() != 1) {
+        return false;
+    }
+    // прочие владельцы могли только читать объект; их чтения должны закончиться до наших записей
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+/*!
+    \brief Указатель на неизменяемое значение, которое один писатель заменяет, а многие читатели читают без блокировок.
+    \details Используется для публикации версий графа в BasicVersionedGraph. Значения лежат в нескольких слотах, атомарный
+    номер current указывает на опубликованный. Читатель закрепляет слот счетчиком readers, проверяет, что слот все еще
+    опубликован, и копирует shared_ptr (копия меняет только атомарный счетчик ссылок); если писатель успел опубликовать
+    другой слот, читатель отпускает закрепление и повторяет попытку. Писатель пишет новое значение в свободный слот, который
+    не опубликован и не закреплен, публикует его и очищает остальные свободные слоты, поэтому старое значение живет,
+    пока его держат читатели, и не дольше следующей публикации. Ни читатель, ни писатель не берут мьютексов; писатель
+    ждет, только если все неопубликованные слоты одновременно закреплены читателями, которые опоздали на публикацию.
+    Store должен вызывать один поток (или вызовы должны быть упорядочены снаружи).
+    * slots - значения и количество читателей, закрепивших каждый слот
+    * current - номер опубликованного слота
+*/
+template <class T, size_t SlotCount = 4>
+class PublishedPtr {
+public:
+    PublishedPtr() = default;
+    PublishedPtr(const PublishedPtr&) = delete;
+    PublishedPtr& operator=(const PublishedPtr&) = delete;
+
+    /*!
+     * @return Опубликованное значение; можно вызывать из любого потока
+     */
+    std::shared_ptr<const T> Load() const {
+        while (true) {
+            size_t i = this->current.load();
+            this->slots[i].readers.fetch_add(1);
+            if (this->current.load() == i) {
+                // пока слот закреплен и опубликован, писатель его не трогает
+                std::shared_ptr<const T> value = this->slots[i].value;
+                this->slots[i].readers.fetch_sub(1, std::memory_order_release);
+                return value;
+            }
+            this->slots[i].readers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+    /*!
+     * Публикует новое значение; вызывается только из потока-писателя
+     */
+    void Store(std::shared_ptr<const T> value) {
+        size_t published = this->current.load(std::memory_order_relaxed);
+        size_t next = published;
+        while (next == published) {
+            for (size_t i = 0; i < SlotCount; i++) {
+                if (i != published && this->slots[i].readers.load() == 0) {
+                    next = i;
+                    break;
+                }
+            }
+            if (next == published) {
+                std::this_thread::yield();
+            }
+        }
+        this->slots[next].value = std::move(value);
+        this->current.store(next);
+        for (size_t i = 0; i < SlotCount; i++) {
+            if (i != next && this->slots[i].value && this->slots[i].readers.load() == 0) {
+                // читатель, закрепивший слот после этой проверки, увидит, что слот не опубликован, и не прочтет его
+                this->slots[i].value.reset();
+            }
+        }
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::shared_ptr<const T> value;
+        std::atomic<uint32_t> readers{0};
+    };
+
+    mutable Slot slots[SlotCount];
+    std::atomic<size_t> current{0};
+};
+
+
+/*!
+    \brief Кэш значения, которое константные методы графа считают лениво, а читатели получают без блокировок.
+    \details Значение публикуется один раз: читатель, который первым его посчитал, ставит атомарный указатель на держатель
+    с shared_ptr, остальные видят держатель одной загрузкой acquire. Если несколько читателей посчитали значение
+    одновременно, в кэше остается одно из них, а остальные варианты отбрасываются. Держатель после публикации не
+    меняется, поэтому shared_ptr из него копируется без синхронизации (копия меняет только атомарный счетчик ссылок).
+    Сбросить, заменить или менять значение может только владелец кэша, у которого нет одновременных читателей, то есть
+    неконстантный метод графа. Копия кэша разделяет значение с оригиналом за O(1).
+    * holder - опубликованный держатель или nullptr, если значение еще не посчитано
+*/
+template <class T>
+class LazyCache {
+public:
+    LazyCache() = default;
+    LazyCache(const LazyCache& other) {
+        this->Store(other.Get());
+    }
+    LazyCache(LazyCache&& other) noexcept : holder(other.holder.exchange(nullptr, std::memory_order_acq_rel)) {}
+    LazyCache& operator=(const LazyCache& other) {
+        if (this != &other) {
+            this->Store(other.Get());
+        }
+        return *this;
+    }
+    LazyCache& operator=(LazyCache&& other) noexcept {
+        if (this != &other) {
+            this->Reset();
+            this->holder.store(other.holder.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_release);
+        }
+        return *this;
+    }
+    ~LazyCache() {
+        this->Reset();
+    }
+
+    /*!
+     * @return Значение или nullptr, если его еще не посчитали
+     */
+    std::shared_ptr<T> Get() const {
+        const Holder* current = this->holder.load(std::memory_order_acquire);
+        return current ? current->value : nullptr;
+    }
+    /*!
+     * Публикует значение, если кэш пуст; можно вызывать из константных методов нескольких потоков
+     * @return Значение, которое осталось в кэше: свое или опубликованное другим читателем раньше
+     */
+    std::shared_ptr<T> Publish(std::shared_ptr<T> value) const {
+        Holder* fresh = new Holder{std::move(value)};
+        Holder* expected = nullptr;
+        if (this->holder.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return fresh->value;
+        }
+        delete fresh;
+        return expected->value;
+    }
+
+    /*!
+     * Значение, которое владелец может менять на месте
+     * @return Значение или nullptr, если его нет; если значение разделяют копии кэша, оно не копируется, а сбрасывается
+     * из этого кэша, и тоже возвращается nullptr
+     */
+    T* Exclusive() {
+        Holder* current = this->holder.load(std::memory_order_acquire);
+        if (!current) {
+            return nullptr;
+        }
+        if (!IsUnique(current->value)) {
+            this->Reset();
+            return nullptr;
+        }
+        return current->value.get();
+    }
+    // заменяет значение; nullptr очищает кэш
+    void Store(std::shared_ptr<T> value) {
+        this->Reset();
+        if (value) {
+            this->holder.store(new Holder{std::move(value)}, std::memory_order_release);
+        }
+    }
+    void Reset() noexcept {
+        delete this->holder.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+private:
+    struct Holder {
+        std::shared_ptr<T> value;
+    };
+
+    mutable std::atomic<Holder*> holder{nullptr};
+};
+
+
+/*!
+    \brief Класс CowPtr - значение, которое копии разделяют до первого изменения (copy-on-write).
+    \details Копирование CowPtr стоит O(1): обе копии ссылаются на один объект. Mutable() копирует объект, только
+    если его держит кто-то еще, поэтому читатели старых копий никогда не видят изменений.
+    Объект T должен поддерживать std::pmr: конструктор от memory_resource* и копирование с memory_resource* последним
+    аргументом. Копии разделяют объект, только если их ресурсы равны, иначе объект копируется в свой ресурс, как у
+    std::pmr контейнеров: копия берет ресурс по умолчанию, присваивание сохраняет свой ресурс.
+    * ptr - разделяемый объект; nullptr означает пустой объект, память под который еще не выделялась
+    * resource - откуда берутся объект и его копии
+*/
+template <class T>
+class CowPtr {
+public:
+    explicit CowPtr(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+        : resource(resource) {}
+    CowPtr(const CowPtr& other, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : resource(resource) {
+        this->share(other);
+    }
+    CowPtr(CowPtr&& other) noexcept : ptr(std::move(other.ptr)), resource(other.resource) {}
+    CowPtr& operator=(const CowPtr& other) {
+        if (this != &other) {
+            this->share(other);
+        }
+        return *this;
+    }
+    // при равных ресурсах объект забирается без выделений, иначе копируется в свой ресурс
+    CowPtr& operator=(CowPtr&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (this->resource->is_equal(*other.resource)) {
+            this->ptr = std::move(other.ptr);
+        } else {
+            this->share(other);
+            other.ptr.reset();
+        }
+        return *this;
+    }
+
+    const T& operator*() const noexcept {
+        return this->ptr ? *this->ptr : Empty();
+    }
+    const T* operator->() const noexcept {
+        return &**this;
+    }
+
+    /*!
+     * @return Объект, который можно менять; если его разделяет кто-то еще, сначала делается своя копия
+     */
+    T& Mutable() {
+        if (!this->ptr) {
+            this->ptr = MakeShared<T>(this->resource, this->resource);
+        } else if (!IsUnique(this->ptr)) {
+            this->ptr = MakeShared<T>(this->resource, *this->ptr, this->resource);
+        }
+        return *this->ptr;
+    }
+
+    std::pmr::memory_resource* Resource() const noexcept {
+        return this->resource;
+    }
+
+private:
+    static const T& Empty() {
+        static const T empty;
+        return empty;
+    }
+
+    void share(const CowPtr& other) {
+        if (!other.ptr || this->resource->is_equal(*other.resource)) {
+            this->ptr = other.ptr;
+        } else {
+            this->ptr = MakeShared<T>(this->resource, *other.ptr, this->resource);
+        }
+    }
+
+    std::shared_ptr<T> ptr;
+    std::pmr::memory_resource* resource;
+};
+
+/*!
+    \brief Класс CowChunks - массив, разбитый на куски по ChunkSize элементов, которые копии разделяют до первого изменения.
+    \details Копирование массива стоит O(n / ChunkSize): копируются только указатели на куски. Mutable(i) копирует
+    лишь кусок с элементом i и лишь тогда, когда этот кусок держит кто-то еще, поэтому копия, в которой изменили
+    несколько элементов, делит с оригиналом все остальные куски. Правила ресурсов такие же, как у CowPtr.
+    Mutable не синхронизирован: перед тем как менять элементы из нескольких потоков, их куски нужно отделить
+    вызовом Unshare в одном потоке.
+    * chunks - указатели на куски; все куски, кроме последнего, заполнены целиком
+    * count - количество элементов
+*/
+template <class T, size_t ChunkSize = 256>
+class CowChunks {
+public:
+    using Chunk = std::pmr::vector<T>;
+
+    explicit CowChunks(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+        : chunks(resource) {}
+    CowChunks(const CowChunks& other, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : chunks(resource) {
+        this->share(other);
+    }
+    CowChunks(CowChunks&& other) noexcept : chunks(std::move(other.chunks)), count(std::exchange(other.count, 0)) {}
+    CowChunks& operator=(const CowChunks& other) {
+        if (this != &other) {
+            this->share(other);
+        }
+        return *this;
+    }
+    // при равных ресурсах массив указателей на куски забирается без выделений, иначе куски копируются в свой ресурс
+    CowChunks& operator=(CowChunks&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (this->Resource()->is_equal(*other.Resource())) {
+            this->chunks = std::move(other.chunks);
+            other.chunks.clear();
+            this->count = std::exchange(other.count, 0);
+        } else {
+            this->share(other);
+            other.chunks.clear();
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    size_t size() const noexcept {
+        return this->count;
+    }
+    bool empty() const noexcept {
+        return this->count == 0;
+    }
+    const T& operator[](size_t pos) const noexcept {
+        return (*this->chunks[pos / ChunkSize])[pos % ChunkSize];
+    }
+
+    /*!
+     * @return Элемент pos, который можно менять; его кусок сначала отделяется от других копий массива
+     */
+    T& Mutable(size_t pos) {
+        return this->unshare(pos / ChunkSize)[pos % ChunkSize];
+    }
+    /*!
+     * Отделяет от других копий массива кусок с элементом pos, чтобы потом менять его элементы без копирования
+     */
+    void Unshare(size_t pos) {
+        this->unshare(pos / ChunkSize);
+    }
+
+    void emplace_back() {
+        if (this->count % ChunkSize == 0) {
+            this->chunks.push_back(MakeShared<Chunk>(this->Resource(), this->Resource()));
+        }
+        this->unshare(this->count / ChunkSize).emplace_back();
+        this->count++;
+    }
+    void pop_back() {
+        this->count--;
+        if (this->count % ChunkSize == 0) {
+            // кусок пустеет целиком, копировать его незачем
+            this->chunks.pop_back();
+        } else {
+            this->unshare(this->count / ChunkSize).pop_back();
+        }
+    }
+    void resize(size_t n) {
+        while (this->count > n) {
+            this->pop_back();
+        }
+        while (this->count < n) {
+            this->emplace_back();
+        }
+    }
+
+    std::pmr::memory_resource* Resource() const noexcept {
+        return this->chunks.get_allocator().resource();
+    }
+
+private:
+    Chunk& unshare(size_t chunk) {
+        std::shared_ptr<Chunk>& ptr = this->chunks[chunk];
+        if (!IsUnique(ptr)) {
+            ptr = MakeShared<Chunk>(this->Resource(), *ptr, this->Resource());
+        }
+        return *ptr;
+    }
+
+    void share(const CowChunks& other) {
+        bool equal = this->Resource()->is_equal(*other.Resource());
+        std::pmr::vector<std::shared_ptr<Chunk>> shared(this->Resource());
+        shared.reserve(other.chunks.size());
+        for (auto& chunk : other.chunks) {
+            shared.push_back(equal ? chunk : MakeShared<Chunk>(this->Resource(), *chunk, this->Resource()));
+        }
+        this->chunks = std::move(shared);
+        this->count = other.count;
+    }
+
+    std::pmr::vector<std::shared_ptr<Chunk>> chunks;
+    size_t count = 0;
+};
+
+}
+
+#endif
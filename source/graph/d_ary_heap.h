@@ -0,0 +1,134 @@
+#ifndef GRAPH_D_ARY_HEAP_H
+#define GRAPH_D_ARY_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace detail {
+
+/*!
+    \brief Класс IndexedDaryHeap - d-арная куча с минимумом наверху для элементов 0..n-1 с уменьшением ключа на месте.
+    \details Каждый элемент лежит в куче не больше одного раза; для него хранится позиция в куче, поэтому DecreaseKey
+    поднимает элемент от его места за O(log_d n), не добавляя в кучу дубликатов. Pop опускает элемент за O(d log_d n).
+    Большая арность делает кучу ниже: уменьшений ключа в алгоритме Прима столько же, сколько ребер, а извлечений -
+    сколько вершин, поэтому на плотном графе выгодна d порядка E / V.
+    Ключ и номер элемента лежат в куче рядом, чтобы сравнение детей не обращалось к другим массивам.
+    * entries - куча пар (ключ, элемент)
+    * position - позиция элемента в entries, kAbsent для элементов вне кучи
+    * arity - количество детей у узла
+*/
+template <class Key>
+class IndexedDaryHeap {
+public:
+    static constexpr uint32_t kAbsent = UINT32_MAX;
+
+    /*!
+     * @param n количество элементов
+     * @param arity количество детей у узла, не меньше 2
+     */
+    IndexedDaryHeap(size_t n, size_t arity) : position(n, kAbsent), arity(arity < 2 ? 2 : arity) {}
+
+    bool Empty() const noexcept {
+        return this->entries.empty();
+    }
+    bool Contains(uint32_t id) const noexcept {
+        return this->position[id] != kAbsent;
+    }
+    const Key& KeyOf(uint32_t id) const noexcept {
+        return this->entries[this->position[id]].key;
+    }
+
+    /*!
+     * Добавляет элемент, которого нет в куче
+     */
+    void Push(uint32_t id, const Key& key) {
+        this->entries.push_back({key, id});
+        this->siftUp(this->entries.size() - 1);
+    }
+    /*!
+     * Уменьшает ключ элемента, который лежит в куче
+     */
+    void DecreaseKey(uint32_t id, const Key& key) {
+        size_t pos = this->position[id];
+        this->entries[pos].key = key;
+        this->siftUp(pos);
+    }
+    // элемент с наименьшим ключом
+    uint32_t Top() const noexcept {
+        return this->entries[0].id;
+    }
+
+    /*!
+     * Достает элемент с наименьшим ключом
+     * @return Номер элемента
+     */
+    uint32_t Pop() {
+        uint32_t top = this->entries[0].id;
+        this->position[top] = kAbsent;
+        Entry last = this->entries.back();
+        this->entries.pop_back();
+        if (!this->entries.empty()) {
+            this->siftDown(last);
+        }
+        return top;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        uint32_t id;
+    };
+
+    void siftUp(size_t pos) {
+        Entry entry = this->entries[pos];
+        while (pos > 0) {
+            size_t parent = (pos - 1) / this->arity;
+            if (!(entry.key < this->entries[parent].key)) {
+                break;
+            }
+            this->place(pos, this->entries[parent]);
+            pos = parent;
+        }
+        this->place(pos, entry);
+    }
+
+    // ставит entry на вершину кучи и опускает ее
+    void siftDown(const Entry& entry) {
+        size_t pos = 0;
+        size_t size = this->entries.size();
+        while (true) {
+            size_t first = pos * this->arity + 1;
+            if (first >= size) {
+                break;
+            }
+            size_t last = first + this->arity < size ? first + this->arity : size;
+            size_t best = first;
+            for (size_t child = first + 1; child < last; child++) {
+                if (this->entries[child].key < this->entries[best].key) {
+                    best = child;
+                }
+            }
+            if (!(this->entries[best].key < entry.key)) {
+                break;
+            }
+            this->place(pos, this->entries[best]);
+            pos = best;
+        }
+        this->place(pos, entry);
+    }
+
+    void place(size_t pos, const Entry& entry) {
+        this->entries[pos] = entry;
+        this->position[entry.id] = pos;
+    }
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> position;
+    size_t arity;
+};
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef GRAPH_EDGE_RANGE_H
+#define GRAPH_EDGE_RANGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "adjacency.h"
+#include "cow.h"
+
+
+/*!
+    \brief Порядок обхода ребер в BasicGraph::Edges.
+    * Storage - в порядке хранения: по внутренним индексам вершин, без дополнительной работы
+    * ByVertex - по возрастанию номера меньшего конца ребра, как в исходном AllEdges; перестановка вершин
+      считается один раз и кэшируется до изменения множества вершин
+*/
+enum class EdgeOrder {
+    Storage,
+    ByVertex
+};
+
+/*!
+    \brief Класс EdgeRange - ленивый диапазон всех ребер графа.
+    \details Ребра не складываются в массив: итератор идет по спискам смежности и собирает объект Edge из
+    очередного полуребра. Каждое ребро встречается один раз - у конца с меньшим номером, петля тоже один раз.
+    Диапазон ничего не меняет в графе, поэтому несколько потоков могут обходить ребра одновременно.
+    Диапазон и его итераторы действительны, пока граф не изменяется.
+    * source - откуда берутся ребра, итераторы хранят копию и не ссылаются на сам диапазон
+    * order_holder - владеет порядком обхода вершин, пока жив диапазон
+*/
+template <class VertexId, class Weight, class Edge>
+class EdgeRange {
+public:
+    using List = AdjacencyList<Weight>;
+    using Half = HalfEdge<Weight>;
+
+    /*!
+        \brief Все, что нужно итератору, чтобы обойти ребра.
+        * lists - списки смежности графа
+        * ids - таблица перевода внутреннего индекса вершины в ее номер
+        * n - количество вершин
+        * order - порядок обхода вершин (для EdgeOrder::ByVertex) или nullptr для порядка хранения
+    */
+    struct Source {
+        const detail::CowChunks<List>* lists;
+        const VertexId* ids;
+        size_t n;
+        const uint32_t* order;
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Edge;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Edge;
+
+        Iterator() = default;
+        Iterator(const Source& source, size_t pos) : source(source), pos(pos) {
+            if (this->pos < this->source.n) {
+                this->enter();
+                this->settle();
+            }
+        }
+
+        Edge operator*() const {
+            VertexId from_v = this->source.ids[this->from];
+            VertexId to_v = this->source.ids[this->half->to];
+            if constexpr (std::is_void_v<Weight>) {
+                return Edge(from_v, to_v);
+            } else {
+                return Edge(from_v, to_v, this->half->weight);
+            }
+        }
+
+        Iterator& operator++() {
+            ++this->half;
+            this->settle();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) {
+            return a.pos == b.pos && (a.pos == a.source.n || a.half == b.half);
+        }
+        friend bool operator!=(const Iterator& a, const Iterator& b) {
+            return !(a == b);
+        }
+
+    private:
+        // переходит к списку вершины на позиции pos
+        void enter() {
+            this->from = this->source.order ? this->source.order[this->pos] : this->pos;
+            const List& list = (*this->source.lists)[this->from];
+            this->half = list.begin();
+            this->last = list.end();
+        }
+
+        // пропускает полуребра, ребро которых выдается у другого конца, и пустые списки
+        void settle() {
+            while (true) {
+                while (this->half != this->last && this->source.ids[this->from] > this->source.ids[this->half->to]) {
+                    ++this->half;
+                }
+                if (this->half != this->last) {
+                    return;
+                }
+                if (++this->pos == this->source.n) {
+                    return;
+                }
+                this->enter();
+            }
+        }
+
+        Source source = {};
+        size_t pos = 0;
+        size_t from = 0;
+        const Half* half = nullptr;
+        const Half* last = nullptr;
+    };
+
+    EdgeRange(const detail::CowChunks<List>* lists, const VertexId* ids, size_t n, std::shared_ptr<const std::vector<uint32_t>> order)
+        : source{lists, ids, n, order ? order->data() : nullptr}, order_holder(std::move(order)) {}
+
+    Iterator begin() const {
+        return Iterator(this->source, 0);
+    }
+    Iterator end() const {
+        return Iterator(this->source, this->source.n);
+    }
+
+private:
+    Source source;
+    std::shared_ptr<const std::vector<uint32_t>> order_holder;
+};
+
+#endif
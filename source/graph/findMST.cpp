@@ -1,113 +1,704 @@
-#include "graph.h"
+#include "frozen_graph.h"
+#include "subgraph_view.h"
+#include "d_ary_heap.h"
+#include "disjoint_set.h"
+#include "parallel.h"
+#include "radix_sort.h"
+
+#include <atomic>
+
+/*!
+ * Алгоритм Краскала по ребрам, уже упорядоченным по возрастанию веса
+ * @param n количество вершин
+ * @param for_each_edge вызывает visit(from, to, make_edge) для каждого ребра между внутренними индексами from и to
+ * по возрастанию веса; make_edge() собирает ребро для дерева и вызывается только для взятых в дерево ребер
+ * @return Ребра минимального остовного леса
+ */
+template <class Edge, class ForEachEdge>
+std::vector<Edge> Kruskal(size_t n, ForEachEdge&& for_each_edge) {
+    // для каждой вершины создаем отдельный граф
+    DisjointSet sets(n);
+
+    // по возрастанию веса ребер начинаем объединять графы
+    std::vector<Edge> mstEdge;
+    for_each_edge([&](uint32_t from, uint32_t to, auto&& make_edge) {
+        if (sets.Union(from, to)) {
+            mstEdge.push_back(make_edge());
+        }
+    });
+    return mstEdge;
+}
+
+// отрезок ребер, который Filter-Kruskal уже не делит, а сортирует и проходит алгоритмом Краскала; отрезок
+// не длиннее количества вершин тоже не делится: в нем мало ребер, которые можно отбросить
+constexpr size_t kFilterKruskalBase = 1 << 12;
+// сколько ребер отрезка просматривается, чтобы выбрать опорное ребро
+constexpr size_t kPivotSample = 9;
 
 /*!
-    \brief Вспомогательный класс Set непересекающихся множеств для эффективной реализации алгоритма Краскала.
-    \details Каждый объект класса  Set хранит в себе следующую информацию:
-    * root - указатель на Set, который является корневым для поддерева
-    * rank - высота поддерева
-*/
-class Set {
-public:
-    /*!
-     * Создает объект класса Set для одной вершины
-     * @param ind номер вершины
-     */
-    void MakeSet(const size_t& ind) {
-        this->root = this;
-        this->rank = 0;
+ * Алгоритм Filter-Kruskal: ребра делятся опорным ребром на легкие и тяжелые, сначала обрабатываются легкие,
+ * затем из тяжелых выбрасываются ребра, концы которых уже соединены, и остаток обрабатывается так же
+ * @param n количество вершин
+ * @param all_edges ребра между внутренними индексами from и to без петель; массив переставляется
+ * @param lighter строгий порядок ребер: по весу, а при равных весах по концам
+ * @return Ребра минимального остовного леса в порядке lighter
+ * @note Сортируются только отрезки, которые дожили до размера kFilterKruskalBase; тяжелые ребра, замкнутые
+ * легкими, отбрасываются без сортировки, а когда дерево собрано, оставшиеся ребра не просматриваются вовсе.
+ * Разбиение и фильтр параллельны; фильтр ищет корни без сжатия путей, поэтому потоки только читают множества.
+ * Дерево при строгом порядке однозначно и совпадает с деревом Краскала.
+ */
+template <class IndexedEdge, class Lighter>
+std::vector<IndexedEdge> FilterKruskal(size_t n, std::vector<IndexedEdge>& all_edges, Lighter&& lighter) {
+    DisjointSet sets(n);
+    std::vector<IndexedEdge> mstEdge;
+    std::vector<IndexedEdge> buffer;
+    // отрезки ждут обработки в стеке так, что сверху лежит самый легкий; filter - нужно ли сначала отфильтровать отрезок
+    struct Range {
+        size_t lo;
+        size_t hi;
+        bool filter;
+    };
+    std::vector<Range> ranges = {{0, all_edges.size(), false}};
+    while (!ranges.empty() && mstEdge.size() + 1 < n) {
+        auto [lo, hi, filter] = ranges.back();
+        ranges.pop_back();
+        if (filter) {
+            hi = lo + detail::ParallelPartition(all_edges, lo, hi, [&](const IndexedEdge& edge) {
+                return sets.Root(edge.from) != sets.Root(edge.to);
+            }, buffer);
+        }
+
+        if (hi - lo <= std::max(kFilterKruskalBase, n)) {
+            std::sort(all_edges.begin() + lo, all_edges.begin() + hi, lighter);
+            for (size_t i = lo; i < hi; i++) {
+                if (sets.Union(all_edges[i].from, all_edges[i].to)) {
+                    mstEdge.push_back(all_edges[i]);
+                }
+            }
+            continue;
+        }
+
+        // опорное ребро - медиана ребер, взятых из отрезка через равные промежутки; она не самое тяжелое ребро
+        // отрезка, поэтому обе части непустые
+        std::vector<IndexedEdge> sample;
+        for (size_t k = 0; k < kPivotSample; k++) {
+            sample.push_back(all_edges[lo + (hi - lo - 1) * k / (kPivotSample - 1)]);
+        }
+        std::nth_element(sample.begin(), sample.begin() + kPivotSample / 2, sample.end(), lighter);
+        IndexedEdge pivot = sample[kPivotSample / 2];
+        size_t mid = lo + detail::ParallelPartition(all_edges, lo, hi, [&](const IndexedEdge& edge) {
+            return !lighter(pivot, edge);
+        }, buffer);
+        ranges.push_back({mid, hi, true});
+        ranges.push_back({lo, mid, false});
     }
+    return mstEdge;
+}
 
-    /*!
-     * Объединяет множество с другим
-     * @param other указатель на другой объект класса Set
-     */
-    void Union(Set* other) {
-        this->FindSet()->Link(other->FindSet());
+// количество бит, которых хватает на числа 0..max
+unsigned BitWidth(uint64_t max) {
+    unsigned bits = 0;
+    while (bits < 64 && (max >> bits) != 0) {
+        bits++;
     }
+    return bits;
+}
 
-    /*!
-     * Определяет к какому множеству относится поддерево
-     * @return Возвращает указатель на объект класса Set, который является корневым для поддерева
-     */
-    Set* FindSet() {
-        if (this != this->root) {
-            this->root = this->root->FindSet();
+/*!
+ * Устойчиво упорядочивает ребра по весу поразрядной сортировкой 8-байтовых ключей вместо самих ребер
+ * @param edges ребра с целочисленными весами
+ * @return false, если разброс весов и номер ребра не помещаются вместе в 64 бита; тогда ребра не меняются
+ * @note Ключ ребра - (вес - наименьший вес) << index_bits | номер ребра. Ширина ключа берется из наблюдаемого
+ * разброса весов, и сортируются только биты веса: номера ребер уже идут по возрастанию, а сортировка устойчива.
+ * Затем ребра параллельно переставляются по номерам из ключей.
+ */
+template <class IndexedEdge>
+bool RadixSortByWeight(std::vector<IndexedEdge>& edges) {
+    using Weight = decltype(IndexedEdge::weight);
+    if constexpr (!std::is_integral_v<Weight>) {
+        return false;
+    } else {
+        size_t m = edges.size();
+        if (m < 2) {
+            return true;
         }
-        return this->root;
+        size_t threads = detail::ThreadCount(m);
+        std::vector<Weight> part_min(threads, edges[0].weight);
+        std::vector<Weight> part_max(threads, edges[0].weight);
+        detail::ParallelChunks(0, m, threads, [&](size_t part, size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                part_min[part] = std::min(part_min[part], edges[i].weight);
+                part_max[part] = std::max(part_max[part], edges[i].weight);
+            }
+        });
+        Weight min = *std::min_element(part_min.begin(), part_min.end());
+        Weight max = *std::max_element(part_max.begin(), part_max.end());
+        // разность в беззнаковой арифметике верна для любых целых весов, даже если в Weight она переполняется
+        unsigned weight_bits = BitWidth(uint64_t(max) - uint64_t(min));
+        unsigned index_bits = BitWidth(m - 1);
+        if (weight_bits + index_bits > 64) {
+            return false;
+        }
+
+        std::vector<uint64_t> keys(m);
+        detail::ParallelFor(0, m, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                keys[i] = ((uint64_t(edges[i].weight) - uint64_t(min)) << index_bits) | i;
+            }
+        });
+        detail::RadixSort(keys, index_bits, index_bits + weight_bits);
+
+        uint64_t index_mask = (uint64_t(1) << index_bits) - 1;
+        std::vector<IndexedEdge> sorted(m);
+        detail::ParallelFor(0, m, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                sorted[i] = edges[keys[i] & index_mask];
+            }
+        });
+        edges.swap(sorted);
+        return true;
+    }
+}
+
+// средняя степень вершины, начиная с которой MstAlgorithm::Auto выбирает Прима (см. BenchMst в graph_bench.cpp)
+constexpr size_t kPrimMinAverageDegree = 32;
+
+/*!
+ * Алгоритм Прима на индексированной d-арной куче
+ * @param n количество вершин
+ * @param half_edges количество полуребер, по нему выбирается арность кучи
+ * @param for_each_neighbor вызывает f(to, weight) для каждого полуребра вершины v
+ * @param make_edge собирает ребро дерева make_edge(parent, v, weight) из внутренних индексов концов и веса ребра
+ * @return Ребра минимального остовного дерева компоненты вершины 0; если граф несвязный, их меньше n - 1
+ */
+template <class Edge, class Key, class ForEachNeighbor, class MakeEdge>
+std::vector<Edge> Prim(size_t n, size_t half_edges, ForEachNeighbor&& for_each_neighbor, MakeEdge&& make_edge) {
+    std::vector<Edge> mstEdge;
+    if (n == 0) {
+        return mstEdge;
     }
-private:
-    void Link(Set* other) {
-        if (this->rank > other->rank) {
-            other->root = this;
-        } else {
-            this->root = other;
-            if (this->rank == other->rank) {
-                other->rank += 1;
+    mstEdge.reserve(n - 1);
+
+    // parent[v] - вершина дерева, через которую v дешевле всего присоединить; в дереве вершина помечается kInTree
+    constexpr uint32_t kInTree = UINT32_MAX;
+    std::vector<uint32_t> parent(n, kInTree - 1);
+    detail::IndexedDaryHeap<Key> heap(n, half_edges / n);
+    auto attach = [&](uint32_t v) {
+        parent[v] = kInTree;
+        for_each_neighbor(v, [&](uint32_t to, const Key& weight) {
+            if (parent[to] == kInTree) {
+                return;
+            }
+            if (!heap.Contains(to)) {
+                heap.Push(to, weight);
+                parent[to] = v;
+            } else if (weight < heap.KeyOf(to)) {
+                heap.DecreaseKey(to, weight);
+                parent[to] = v;
             }
+        });
+    };
+
+    attach(0);
+    while (!heap.Empty()) {
+        // ключ вершины в куче - вес самого легкого ребра к дереву, поэтому он берется до извлечения
+        uint32_t v = heap.Top();
+        mstEdge.push_back(make_edge(parent[v], v, heap.KeyOf(v)));
+        heap.Pop();
+        attach(v);
+    }
+    return mstEdge;
+}
+
+/*!
+ * Параллельный алгоритм Борувки
+ * @param n количество вершин
+ * @param all_edges ребра между внутренними индексами from и to без петель
+ * @param lighter строгий порядок ребер: по весу, а при равных весах по концам
+ * @return Номера ребер минимального остовного леса в all_edges, упорядоченные по lighter
+ * @note Каждый раунд параллельно находит у каждой компоненты самое легкое исходящее ребро, подвешивает компоненту
+ * к соседней по этому ребру, сжимает компоненты и выбрасывает ребра, ставшие петлями. Компонент в каждом раунде
+ * становится хотя бы вдвое меньше. Порядок lighter строгий, поэтому две компоненты могут выбрать друг друга только
+ * одним и тем же ребром, циклов не бывает, а дерево однозначно и не зависит от числа потоков - оно совпадает
+ * с деревом алгоритма Краскала при том же порядке ребер.
+ */
+template <class IndexedEdge, class Lighter>
+std::vector<uint32_t> Boruvka(size_t n, const std::vector<IndexedEdge>& all_edges, Lighter&& lighter) {
+    constexpr uint32_t kNone = UINT32_MAX;
+    // ребро между текущими компонентами концов; id - номер ребра в all_edges
+    struct Link {
+        uint32_t from;
+        uint32_t to;
+        uint32_t id;
+    };
+
+    std::vector<Link> links(all_edges.size());
+    detail::ParallelFor(0, links.size(), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            links[i] = {all_edges[i].from, all_edges[i].to, static_cast<uint32_t>(i)};
         }
+    });
+    // parent[v] - компонента вершины v; между раундами он сжат, и компонента - это ее корневая вершина
+    std::vector<uint32_t> parent(n);
+    std::vector<uint32_t> next(n);
+    std::vector<std::atomic<uint32_t>> best(n);
+    detail::ParallelFor(0, n, [&](size_t lo, size_t hi) {
+        for (size_t v = lo; v < hi; v++) {
+            parent[v] = v;
+        }
+    });
+
+    std::vector<uint32_t> tree;
+    while (!links.empty()) {
+        // 1. самое легкое ребро каждой компоненты
+        detail::ParallelFor(0, n, [&](size_t lo, size_t hi) {
+            for (size_t v = lo; v < hi; v++) {
+                best[v].store(kNone, std::memory_order_relaxed);
+            }
+        });
+        auto relax = [&](std::atomic<uint32_t>& slot, uint32_t id) {
+            uint32_t current = slot.load(std::memory_order_relaxed);
+            while ((current == kNone || lighter(all_edges[id], all_edges[current])) &&
+                   !slot.compare_exchange_weak(current, id, std::memory_order_relaxed)) {
+            }
+        };
+        detail::ParallelFor(0, links.size(), [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                relax(best[links[i].from], links[i].id);
+                relax(best[links[i].to], links[i].id);
+            }
+        });
+
+        // 2. компонента подвешивается к соседней по своему ребру; из пары компонент, выбравших друг друга,
+        // корнем остается меньшая, и ребро пары попадает в дерево один раз
+        size_t threads = detail::ThreadCount(n);
+        std::vector<std::vector<uint32_t>> taken(threads);
+        detail::ParallelChunks(0, n, threads, [&](size_t part, size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; c++) {
+                next[c] = parent[c];
+                uint32_t id = parent[c] == c ? best[c].load(std::memory_order_relaxed) : kNone;
+                if (id == kNone) {
+                    continue;
+                }
+                uint32_t other = parent[all_edges[id].from] == c ? parent[all_edges[id].to] : parent[all_edges[id].from];
+                if (best[other].load(std::memory_order_relaxed) == id && c < other) {
+                    continue;
+                }
+                next[c] = other;
+                taken[part].push_back(id);
+            }
+        });
+        for (auto& part : taken) {
+            tree.insert(tree.end(), part.begin(), part.end());
+        }
+        parent.swap(next);
+
+        // 3. сжатие: перескоки по родителям, пока каждая вершина не укажет на корень своей компоненты
+        bool changed = true;
+        while (changed) {
+            std::atomic<bool> any(false);
+            detail::ParallelFor(0, n, [&](size_t lo, size_t hi) {
+                bool local = false;
+                for (size_t v = lo; v < hi; v++) {
+                    next[v] = parent[parent[v]];
+                    local |= next[v] != parent[v];
+                }
+                if (local) {
+                    any.store(true, std::memory_order_relaxed);
+                }
+            });
+            parent.swap(next);
+            changed = any.load(std::memory_order_relaxed);
+        }
+
+        // 4. ребра переходят на компоненты концов, ребра внутри компоненты выбрасываются
+        threads = detail::ThreadCount(links.size());
+        std::vector<size_t> kept(threads + 1, 0);
+        detail::ParallelChunks(0, links.size(), threads, [&](size_t part, size_t lo, size_t hi) {
+            size_t count = 0;
+            for (size_t i = lo; i < hi; i++) {
+                count += parent[links[i].from] != parent[links[i].to];
+            }
+            kept[part + 1] = count;
+        });
+        for (size_t part = 0; part < threads; part++) {
+            kept[part + 1] += kept[part];
+        }
+        std::vector<Link> remaining(kept[threads]);
+        detail::ParallelChunks(0, links.size(), threads, [&](size_t part, size_t lo, size_t hi) {
+            size_t place = kept[part];
+            for (size_t i = lo; i < hi; i++) {
+                uint32_t from = parent[links[i].from];
+                uint32_t to = parent[links[i].to];
+                if (from != to) {
+                    remaining[place++] = {from, to, links[i].id};
+                }
+            }
+        });
+        links.swap(remaining);
     }
 
-    Set* root;
-    size_t rank;
-};
+    // дерево не зависит от потоков, но порядок сбора зависит от раундов; порядок lighter делает результат таким же,
+    // как у Краскала
+    std::sort(tree.begin(), tree.end(), [&](uint32_t a, uint32_t b) {
+        return lighter(all_edges[a], all_edges[b]);
+    });
+    return tree;
+}
 
+// на одном потоке Борувка примерно вдвое медленнее Краскала (см. BenchMst), поэтому он выбирается,
+// только если ребра можно поделить хотя бы на столько потоков
+constexpr size_t kBoruvkaMinThreads = 4;
 
-Graph Graph::FindMST() { // поиск минимального остовного дерева, вернет его в виде графа
-    // внутри функции связка индекса и номера вершины не изменяется, поэтому создадим map, чтобы узнавать индекс вершины за O(1)
-    std::map<int,size_t> ind_num;
-    for (size_t i = 0; i < this->vertex.size(); i++) {
-        ind_num[this->vertex[i]] = i;
+/*!
+ * Выбирает алгоритм для MstAlgorithm::Auto по средней степени вершины, количеству потоков и типу весов:
+ * целые веса Краскал сортирует поразрядно и на разреженных графах обгоняет Filter-Kruskal, а остальные
+ * сортирует сравнениями, и тогда Filter-Kruskal быстрее
+ */
+template <class Weight>
+MstAlgorithm ChooseMstAlgorithm(size_t n, size_t half_edges) {
+    if (n > 0 && half_edges / n >= kPrimMinAverageDegree) {
+        return MstAlgorithm::Prim;
+    }
+    if (detail::ThreadCount(half_edges / 2) >= kBoruvkaMinThreads) {
+        return MstAlgorithm::Boruvka;
     }
+    return std::is_void_v<Weight> || std::is_integral_v<Weight> ? MstAlgorithm::Kruskal : MstAlgorithm::FilterKruskal;
+}
+
 
-    // сначала сделаем общий массив ребер, чтобы иметь возможность его отсортировать по весу ребер
-    int edge_cnt = 0;
-    for (size_t i = 0; i < this->edge.size(); i++) {
-        edge_cnt += this->edge[i].size();
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::spanningTree(const std::vector<Edge>& tree, size_t n,
+                                                                        std::pmr::memory_resource* resource) {
+    BasicGraph result(tree, DuplicateEdges::Reject, resource);
+    // у пустого графа остовное дерево пустое
+    if (n == 0) {
+        return result;
     }
-    edge_cnt /= 2;
 
-    std::vector<Edge> all_edges(edge_cnt);
-    int k = 0;
-    std::sort(this->vertex.begin(), this->vertex.end());
-    for (size_t i = 0; i < this->vertex.size(); i++) {
-        for (size_t j = 0; j < this->edge[i].size(); j++) {
-            if (this->vertex[i] < this->edge[i][j].other_vertex) {
-                this->edge[i][j].from_vertex = this->vertex[i];
-                all_edges[k++] = this->edge[i][j];
+    // в остовном дереве связного графа ровно n - 1 ребро; меньше - значит, граф несвязный
+    if (static_cast<size_t>(result.Size()) != n || tree.size() + 1 != n) {
+        throw Exceptions("Минимальное остовное дерево не найдено\n");
+    }
+    return result;
+}
+
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::FindMST(std::pmr::memory_resource* resource) const { // поиск минимального остовного дерева, вернет его в виде графа
+    return this->FindMST(MstAlgorithm::Auto, resource);
+}
+
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::FindMST(MstAlgorithm algorithm, std::pmr::memory_resource* resource) const {
+    size_t n = this->vertex->size();
+    size_t half_edges = 0;
+    for (size_t i = 0; i < n; i++) {
+        half_edges += this->edge[i].size();
+    }
+    // индекс весов используется, только если он уже построен: ради одного остовного дерева его не строят
+    bool indexed = false;
+    if constexpr (!std::is_void_v<Weight>) {
+        indexed = this->weight_index.Get() != nullptr;
+    }
+    if (algorithm == MstAlgorithm::Auto) {
+        // по индексу весов Краскал обходится без сортировки, он быстрее Прима на любой плотности
+        algorithm = indexed ? MstAlgorithm::Kruskal : ChooseMstAlgorithm<Weight>(n, half_edges);
+    }
+
+    if (algorithm == MstAlgorithm::Prim) {
+        // Прим обходит списки смежности на месте, снимок графа не нужен
+        using Key = std::conditional_t<std::is_void_v<Weight>, uint8_t, Weight>;
+        std::vector<Edge> mstEdge = Prim<Edge, Key>(n, half_edges, [&](uint32_t v, auto&& f) {
+            for (auto& half : this->edge[v]) {
+                if constexpr (std::is_void_v<Weight>) {
+                    f(half.to, Key(0));
+                } else {
+                    f(half.to, half.weight);
+                }
             }
+        }, [&](uint32_t from, uint32_t to, const Key& weight) {
+            VertexId from_v = (*this->vertex)[from];
+            VertexId to_v = (*this->vertex)[to];
+            if constexpr (std::is_void_v<Weight>) {
+                return Edge(std::min(from_v, to_v), std::max(from_v, to_v));
+            } else {
+                return Edge(std::min(from_v, to_v), std::max(from_v, to_v), weight);
+            }
+        });
+        return spanningTree(mstEdge, n, resource);
+    }
+
+    if constexpr (!std::is_void_v<Weight>) {
+        std::shared_ptr<const detail::WeightIndex<VertexId, Weight>> index = this->weight_index.Get();
+        if (algorithm == MstAlgorithm::Kruskal && index) {
+            // индекс весов уже упорядочен, поэтому ребра не собираются и не сортируются
+            std::vector<Edge> mstEdge = Kruskal<Edge>(n, [&](auto&& visit) {
+                for (auto& key : *index) {
+                    if (key.from != key.to) {
+                        visit(this->findVertex(key.from), this->findVertex(key.to), [&] {
+                            return Edge(key.from, key.to, key.weight);
+                        });
+                    }
+                }
+            });
+            return spanningTree(mstEdge, n, resource);
         }
     }
+    // Краскал без индекса и Борувка работают по снимку: общий массив ребер собирается из его непрерывных массивов
+    return this->Freeze().FindMST(algorithm, resource);
+}
+
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight> BasicFrozenGraph<VertexId, Weight>::FindMST(std::pmr::memory_resource* resource) const {
+    return this->FindMST(MstAlgorithm::Auto, resource);
+}
 
-    // теперь отсортируем полученный массив по весам ребер
-    std::sort(all_edges.begin(), all_edges.end(), [](Edge a, Edge b) {
-        return a.weight < b.weight;
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight> BasicFrozenGraph<VertexId, Weight>::FindMST(MstAlgorithm algorithm, std::pmr::memory_resource* resource) const {
+    size_t n = this->vertex.size();
+    if (algorithm == MstAlgorithm::Auto) {
+        algorithm = ChooseMstAlgorithm<Weight>(n, this->neighbor.size());
+    }
+
+    // в снимке вершины уже пронумерованы индексами 0..n-1, поэтому ребро можно хранить через индексы концов
+    // у невзвешенного графа вес не хранится
+    auto make_edge = [&](uint32_t from, uint32_t to, const auto&... weight) {
+        VertexId from_v = this->vertex[from];
+        VertexId to_v = this->vertex[to];
+        return Edge(std::min(from_v, to_v), std::max(from_v, to_v), weight...);
+    };
+
+    if (algorithm == MstAlgorithm::Prim) {
+        using Key = std::conditional_t<std::is_void_v<Weight>, uint8_t, Weight>;
+        std::vector<Edge> mstEdge = Prim<Edge, Key>(n, this->neighbor.size(), [&](uint32_t v, auto&& f) {
+            for (size_t k = this->offset[v]; k < this->offset[v + 1]; k++) {
+                if constexpr (std::is_void_v<Weight>) {
+                    f(this->neighbor[k], Key(0));
+                } else {
+                    f(this->neighbor[k], this->weight[k]);
+                }
+            }
+        }, [&](uint32_t from, uint32_t to, const Key& weight) {
+            if constexpr (std::is_void_v<Weight>) {
+                return make_edge(from, to);
+            } else {
+                return make_edge(from, to, weight);
+            }
+        });
+        return Graph::spanningTree(mstEdge, n, resource);
+    }
+
+    using EdgeWeight = std::conditional_t<std::is_void_v<Weight>, NoWeights, Weight>;
+    struct IndexedEdge {
+        uint32_t from;
+        uint32_t to;
+        EdgeWeight weight;
+    };
+
+    // сначала сделаем общий массив ребер, чтобы иметь возможность его отсортировать по весу ребер;
+    // место ребер вершины в массиве - количество ребер у вершин перед ней, поэтому вершины заполняются параллельно
+    std::vector<size_t> place(n);
+    detail::ParallelFor(0, n, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            size_t count = 0;
+            for (size_t k = this->offset[i]; k < this->offset[i + 1]; k++) {
+                count += i < this->neighbor[k];
+            }
+            place[i] = count;
+        }
+    });
+    std::vector<IndexedEdge> all_edges(detail::ParallelExclusiveScan(place));
+    detail::ParallelFor(0, n, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            size_t j = place[i];
+            for (size_t k = this->offset[i]; k < this->offset[i + 1]; k++) {
+                if (i < this->neighbor[k]) {
+                    if constexpr (std::is_void_v<Weight>) {
+                        all_edges[j++] = {static_cast<uint32_t>(i), this->neighbor[k], {}};
+                    } else {
+                        all_edges[j++] = {static_cast<uint32_t>(i), this->neighbor[k], this->weight[k]};
+                    }
+                }
+            }
+            // список хаба не упорядочен по соседу; после упорядочивания номер ребра в массиве растет вместе с концами,
+            // и устойчивая сортировка по весу дает порядок lighter
+            auto first = all_edges.begin() + place[i];
+            auto last = all_edges.begin() + (i + 1 < n ? place[i + 1] : all_edges.size());
+            auto by_to = [](const IndexedEdge& a, const IndexedEdge& b) {
+                return a.to < b.to;
+            };
+            if (!std::is_sorted(first, last, by_to)) {
+                std::sort(first, last, by_to);
+            }
+        }
     });
 
-    // далее выполняем алгоритм
-    std::vector<Set> sets(this->Size());
+    // ребра упорядочены по весу, а при равных весах по концам
+    auto lighter = [](const IndexedEdge& a, const IndexedEdge& b) {
+        if constexpr (!std::is_void_v<Weight>) {
+            if (a.weight != b.weight) {
+                return a.weight < b.weight;
+            }
+        }
+        return a.from < b.from || (a.from == b.from && a.to < b.to);
+    };
 
-    // для каждой вершины создаем отдельный граф
-    for (size_t i = 0; i < this->Size(); i++) {
-        sets[i].MakeSet(i);
+    if (algorithm == MstAlgorithm::FilterKruskal) {
+        std::vector<Edge> mstEdge;
+        mstEdge.reserve(n);
+        for (auto& edge : FilterKruskal(n, all_edges, lighter)) {
+            if constexpr (std::is_void_v<Weight>) {
+                mstEdge.push_back(make_edge(edge.from, edge.to));
+            } else {
+                mstEdge.push_back(make_edge(edge.from, edge.to, edge.weight));
+            }
+        }
+        return Graph::spanningTree(mstEdge, n, resource);
     }
 
-    // по возрастанию веса ребер начинаем объединять графы
-    std::vector<Edge> mstEdge;
-    for (auto& edge : all_edges) {
-        int ind1 = ind_num[edge.from_vertex];
-        int ind2 = ind_num[edge.other_vertex];
+    if (algorithm == MstAlgorithm::Boruvka) {
+        std::vector<uint32_t> tree = Boruvka(n, all_edges, lighter);
+        std::vector<Edge> mstEdge;
+        mstEdge.reserve(tree.size());
+        for (uint32_t id : tree) {
+            if constexpr (std::is_void_v<Weight>) {
+                mstEdge.push_back(make_edge(all_edges[id].from, all_edges[id].to));
+            } else {
+                mstEdge.push_back(make_edge(all_edges[id].from, all_edges[id].to, all_edges[id].weight));
+            }
+        }
+        return Graph::spanningTree(mstEdge, n, resource);
+    }
 
-        if (sets[ind1].FindSet() != sets[ind2].FindSet()) {
-            mstEdge.push_back(edge);
-            sets[ind1].Union(&sets[ind2]);
+    // теперь отсортируем полученный массив по весам ребер; у невзвешенного графа все ребра равноценны,
+    // и подходит любой порядок, поэтому сортировка не нужна
+    if constexpr (!std::is_void_v<Weight>) {
+        if (!RadixSortByWeight(all_edges)) {
+            std::sort(all_edges.begin(), all_edges.end(), lighter);
         }
     }
-    Graph result(mstEdge);
 
-    if (result.Size() != this->Size()) {
-        throw Exceptions("Минимальное остовное дерево не найдено\n");
+    // далее выполняем алгоритм
+    std::vector<Edge> mstEdge = Kruskal<Edge>(n, [&](auto&& visit) {
+        for (auto& edge : all_edges) {
+            visit(edge.from, edge.to, [&] {
+                if constexpr (std::is_void_v<Weight>) {
+                    return make_edge(edge.from, edge.to);
+                } else {
+                    return make_edge(edge.from, edge.to, edge.weight);
+                }
+            });
+        }
+    });
+    return Graph::spanningTree(mstEdge, n, resource);
+}
+
+template <class Graph>
+typename SubgraphView<Graph>::ResultGraph SubgraphView<Graph>::FindMST(std::pmr::memory_resource* resource) const {
+    return this->FindMST(MstAlgorithm::Auto, resource);
+}
+
+template <class Graph>
+typename SubgraphView<Graph>::ResultGraph SubgraphView<Graph>::FindMST(MstAlgorithm algorithm, std::pmr::memory_resource* resource) const {
+    // алгоритмам нужны вершины 0..n-1, поэтому оставленные вершины нумеруются подряд; сам граф не копируется
+    size_t n = this->vertex_count;
+    std::vector<uint32_t> remap(this->vertexCount(), HashIndex<VertexId>::kNotFound);
+    std::vector<uint32_t> original;
+    original.reserve(n);
+    size_t half_edges = 0;
+    for (size_t i = 0; i < this->vertexCount(); i++) {
+        if (this->keeps(i)) {
+            remap[i] = original.size();
+            original.push_back(i);
+            half_edges += this->halfCount(i);
+        }
+    }
+    if (algorithm == MstAlgorithm::Auto) {
+        algorithm = ChooseMstAlgorithm<Weight>(n, half_edges);
     }
 
-    return result;
+    auto make_edge = [&](uint32_t from, uint32_t to, const auto&... weight) {
+        VertexId from_v = this->id(original[from]);
+        VertexId to_v = this->id(original[to]);
+        return Edge(std::min(from_v, to_v), std::max(from_v, to_v), weight...);
+    };
+
+    if (algorithm == MstAlgorithm::Prim) {
+        // Прим обходит списки смежности исходного графа через фильтры
+        using Key = std::conditional_t<std::is_void_v<Weight>, uint8_t, Weight>;
+        std::vector<Edge> mstEdge = Prim<Edge, Key>(n, half_edges, [&](uint32_t v, auto&& f) {
+            this->forEachHalf(original[v], [&](uint32_t to, const Edge& e) {
+                if constexpr (std::is_void_v<Weight>) {
+                    f(remap[to], Key(0));
+                } else {
+                    f(remap[to], e.weight);
+                }
+            });
+        }, [&](uint32_t from, uint32_t to, const Key& weight) {
+            if constexpr (std::is_void_v<Weight>) {
+                return make_edge(from, to);
+            } else {
+                return make_edge(from, to, weight);
+            }
+        });
+        return ResultGraph::spanningTree(mstEdge, n, resource);
+    }
+
+    if (algorithm == MstAlgorithm::Kruskal) {
+        // Краскалу нужен только массив оставленных ребер для сортировки, снимок подграфа не строится
+        struct NoWeight {};
+        using EdgeWeight = std::conditional_t<std::is_void_v<Weight>, NoWeight, Weight>;
+        struct IndexedEdge {
+            uint32_t from;
+            uint32_t to;
+            EdgeWeight weight;
+        };
+        std::vector<IndexedEdge> all_edges;
+        for (uint32_t v = 0; v < n; v++) {
+            this->forEachHalf(original[v], [&](uint32_t to, const Edge& e) {
+                if (v < remap[to]) {
+                    if constexpr (std::is_void_v<Weight>) {
+                        all_edges.push_back({v, remap[to], {}});
+                    } else {
+                        all_edges.push_back({v, remap[to], e.weight});
+                    }
+                }
+            });
+        }
+        // у невзвешенного графа подходит любой порядок ребер
+        if constexpr (!std::is_void_v<Weight>) {
+            if (!RadixSortByWeight(all_edges)) {
+                std::sort(all_edges.begin(), all_edges.end(), [](const IndexedEdge& a, const IndexedEdge& b) {
+                    return a.weight < b.weight;
+                });
+            }
+        }
+        std::vector<Edge> mstEdge = Kruskal<Edge>(n, [&](auto&& visit) {
+            for (auto& edge : all_edges) {
+                visit(edge.from, edge.to, [&] {
+                    if constexpr (std::is_void_v<Weight>) {
+                        return make_edge(edge.from, edge.to);
+                    } else {
+                        return make_edge(edge.from, edge.to, edge.weight);
+                    }
+                });
+            }
+        });
+        return ResultGraph::spanningTree(mstEdge, n, resource);
+    }
+
+    // Filter-Kruskal и Борувка работают по снимку подграфа
+    return this->Freeze().FindMST(algorithm, resource);
 }
 
+#define INSTANTIATE(VertexId, Weight) \
+    template BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::FindMST(std::pmr::memory_resource*) const; \
+    template BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::FindMST(MstAlgorithm, std::pmr::memory_resource*) const; \
+    template BasicGraph<VertexId, Weight> BasicFrozenGraph<VertexId, Weight>::FindMST(std::pmr::memory_resource*) const; \
+    template BasicGraph<VertexId, Weight> BasicFrozenGraph<VertexId, Weight>::FindMST(MstAlgorithm, std::pmr::memory_resource*) const; \
+    template BasicGraph<VertexId, Weight> SubgraphView<BasicGraph<VertexId, Weight>>::FindMST(std::pmr::memory_resource*) const; \
+    template BasicGraph<VertexId, Weight> SubgraphView<BasicGraph<VertexId, Weight>>::FindMST(MstAlgorithm, std::pmr::memory_resource*) const; \
+    template BasicGraph<VertexId, Weight> SubgraphView<BasicFrozenGraph<VertexId, Weight>>::FindMST(std::pmr::memory_resource*) const; \
+    template BasicGraph<VertexId, Weight> SubgraphView<BasicFrozenGraph<VertexId, Weight>>::FindMST(MstAlgorithm, std::pmr::memory_resource*) const;
+GRAPH_FOR_EACH_INSTANCE(INSTANTIATE)
+#undef INSTANTIATE
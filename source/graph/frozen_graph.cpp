@@ -0,0 +1,66 @@
+#include "frozen_graph.h"
+
+template <class VertexId, class Weight>
+BasicFrozenGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::Freeze() const {
+    FrozenGraph frozen;
+    frozen.vertex.assign(this->vertex->begin(), this->vertex->end());
+
+    frozen.offset.resize(this->vertex->size() + 1);
+    frozen.offset[0] = 0;
+    for (size_t i = 0; i < this->vertex->size(); i++) {
+        frozen.offset[i + 1] = frozen.offset[i] + this->edge[i].size();
+    }
+
+    frozen.neighbor.resize(frozen.offset.back());
+    if constexpr (!std::is_void_v<Weight>) {
+        frozen.weight.resize(frozen.offset.back());
+    }
+    for (size_t i = 0; i < this->vertex->size(); i++) {
+        size_t k = frozen.offset[i];
+        for (auto& half : this->edge[i]) {
+            frozen.neighbor[k] = half.to;
+            if constexpr (!std::is_void_v<Weight>) {
+                frozen.weight[k] = half.weight;
+            }
+            k++;
+        }
+    }
+
+    return frozen;
+}
+
+template <class VertexId, class Weight>
+int BasicFrozenGraph<VertexId, Weight>::Size() const noexcept {
+    return this->vertex.size();
+}
+
+template <class VertexId, class Weight>
+std::vector<BasicEdge<VertexId, Weight>> BasicFrozenGraph<VertexId, Weight>::AllEdges() const {
+    std::vector<Edge> allEdges;
+    allEdges.reserve(this->neighbor.size() / 2);
+
+    for (size_t i = 0; i < this->vertex.size(); i++) {
+        for (size_t k = this->offset[i]; k < this->offset[i + 1]; k++) {
+            if (this->vertex[i] < this->vertex[this->neighbor[k]]) {
+                if constexpr (std::is_void_v<Weight>) {
+                    allEdges.emplace_back(this->vertex[i], this->vertex[this->neighbor[k]]);
+                } else {
+                    allEdges.emplace_back(this->vertex[i], this->vertex[this->neighbor[k]], this->weight[k]);
+                }
+            }
+        }
+    }
+
+    return allEdges;
+}
+
+template <class VertexId, class Weight>
+std::vector<VertexId> BasicFrozenGraph<VertexId, Weight>::AllVertex() const {
+    return this->vertex;
+}
+
+#define INSTANTIATE(VertexId, Weight) \
+    template class BasicFrozenGraph<VertexId, Weight>; \
+    template BasicFrozenGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::Freeze() const;
+GRAPH_FOR_EACH_INSTANCE(INSTANTIATE)
+#undef INSTANTIATE
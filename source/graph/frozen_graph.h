@@ -0,0 +1,79 @@
+#ifndef GRAPH_FROZEN_GRAPH_H
+#define GRAPH_FROZEN_GRAPH_H
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "graph.h"
+
+
+/*!
+    \brief Класс BasicFrozenGraph - неизменяемый снимок графа в формате CSR (compressed sparse row).
+    \details Снимок строится из BasicGraph за O(V+E) функцией BasicGraph::Freeze и дальше не меняется.
+    Все списки смежности лежат в общих непрерывных массивах, поэтому проход по всем ребрам не прыгает по куче.
+    Каждый объект класса FrozenGraph хранит в себе следующую информацию:
+    * vertex - номера вершин, индекс в этом массиве - индекс вершины в снимке
+    * offset - соседи вершины i лежат в neighbor[offset[i]..offset[i + 1])
+    * neighbor - индексы соседей
+    * weight - веса ребер, параллельно neighbor; у невзвешенного графа отсутствует
+    FrozenGraph - это BasicFrozenGraph<int, int>.
+*/
+template <class VertexId, class Weight>
+class BasicFrozenGraph {
+public:
+    using Edge = BasicEdge<VertexId, Weight>;
+    using Graph = BasicGraph<VertexId, Weight>;
+
+    BasicFrozenGraph() = default;
+
+    /*!
+     * Функция определения размера графа
+     * @return Количество вершин в графе
+     */
+    int Size() const noexcept;
+    /*!
+     * Функция, показывающая ребра графа
+     * @return Список всех ребер графа без петель, как у BasicGraph::AllEdges, но в порядке хранения снимка
+     */
+    std::vector<Edge> AllEdges() const;
+    /*!
+     * Функция, показывающая вершины графа
+     * @return Список всех вершин графа
+     */
+    std::vector<VertexId> AllVertex() const;
+
+    /*!
+     * Функция поиска минимального остовного дерева в связном, взвешенном графе
+     * @param resource источник памяти для результата
+     * @return Объект класса BasicGraph, являющийся минимальным остовным деревом исходного графа
+     * @throw std::exception Если на вход был подан некорректный граф, для которого нельзя построить минимальное остовное дерево
+     */
+    Graph FindMST(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    /*!
+     * Функция поиска минимального остовного дерева указанным алгоритмом
+     * @param algorithm алгоритм; MstAlgorithm::Auto выбирает Прима на плотных графах, а на разреженных
+     * Борувку, Краскала или Filter-Kruskal в зависимости от количества потоков и типа весов
+     * @param resource источник памяти для результата
+     * @return Минимальное остовное дерево
+     * @throw std::exception Если граф несвязный
+     */
+    Graph FindMST(MstAlgorithm algorithm, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+private:
+    friend class BasicGraph<VertexId, Weight>;
+    template <class Graph>
+    friend class SubgraphView;
+
+    // у невзвешенного графа вместо весов пустая заглушка
+    struct NoWeights {};
+
+    std::vector<VertexId> vertex;
+    std::vector<size_t> offset;
+    std::vector<uint32_t> neighbor;
+    std::conditional_t<std::is_void_v<Weight>, NoWeights, std::vector<Weight>> weight;
+};
+
+using FrozenGraph = BasicFrozenGraph<int, int>;
+
+#endif
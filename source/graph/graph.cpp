@@ -1,179 +1,355 @@
 #include "graph.h"
 
+#include "arena.h"
+#include "parallel.h"
+#include "radix_sort.h"
+
 // конструктор
-Graph::Graph(const std::vector<Edge>& edges) {
-    for (auto& edge : edges) {
-        if (this->findVertex(edge.from_vertex) == -1) {
-            this->AddVertex(edge.from_vertex);
-        }
-        if (this->findVertex(edge.other_vertex) == -1) {
-            this->AddVertex(edge.other_vertex);
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight>::BasicGraph(std::pmr::memory_resource* resource)
+    : vertex(resource), edge(resource), vertex_index(resource), weight_index(resource), properties(resource) {}
+
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight>::BasicGraph(const std::vector<Edge>& edges, DuplicateEdges duplicates, std::pmr::memory_resource* resource)
+    : vertex(resource), edge(resource), vertex_index(resource), weight_index(resource), properties(resource) {
+    // 1. собираем номера всех концов ребер, сортируем и убираем повторы - это и есть вершины графа
+    using Key = std::make_unsigned_t<VertexId>;
+    // переворачиваем знаковый бит, чтобы беззнаковый порядок совпадал с порядком VertexId
+    constexpr Key flip = std::is_signed_v<VertexId> ? Key(Key(1) << (sizeof(Key) * 8 - 1)) : Key(0);
+    std::vector<Key> ids(edges.size() * 2);
+    detail::ParallelFor(0, edges.size(), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            ids[2 * i] = static_cast<Key>(edges[i].from_vertex) ^ flip;
+            ids[2 * i + 1] = static_cast<Key>(edges[i].other_vertex) ^ flip;
         }
-
-        this->AddEdge(edge);
+    });
+    detail::RadixSort(ids);
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    size_t n = ids.size();
+    std::pmr::vector<VertexId>& vertex_ids = this->vertex.Mutable();
+    HashIndex<VertexId>& index = this->vertex_index.Mutable();
+    vertex_ids.resize(n);
+    index.Reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        vertex_ids[i] = static_cast<VertexId>(ids[i] ^ flip);
+        index.Assign(vertex_ids[i], i);
     }
+    std::vector<Key>().swap(ids);
+
+    // 2. переводим номера концов ребер во внутренние индексы и раскладываем полуребра по спискам смежности;
+    // пока не убраны повторы, все списки держим упорядоченными, без хеш-индексов
+    std::vector<uint32_t> ends = this->findEnds(edges);
+    this->edge.resize(n);
+    this->appendEdges(ends, edges, SIZE_MAX);
+    std::vector<uint32_t>().swap(ends);
+
+    // 3. списки упорядочены по соседу устойчиво, поэтому повторы стоят рядом и первым идет первое вхождение ребра
+    detail::ParallelFor(0, n, [&](size_t lo, size_t hi) {
+        for (size_t v = lo; v < hi; v++) {
+            uint32_t prev = HashIndex<uint32_t>::kNotFound;
+            this->edge.Mutable(v).RemoveIf([&](const Half& half) {
+                bool repeated = half.to == prev;
+                prev = half.to;
+                if (repeated && duplicates == DuplicateEdges::Reject) {
+                    throw Exceptions("Ребро уже есть в графе\n");
+                }
+                return repeated;
+            }, SIZE_MAX);
+            this->edge.Mutable(v).Rebalance(this->hub_threshold);
+        }
+    }, this->listGrain(1024));
 }
 
 // копирование
-Graph::Graph(const Graph& other) = default;
-Graph& Graph::operator=(const Graph& other) = default;
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight>::BasicGraph(const BasicGraph& other) = default;
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight>::BasicGraph(const BasicGraph& other, std::pmr::memory_resource* resource)
+    : vertex(other.vertex, resource), edge(other.edge, resource), vertex_index(other.vertex_index, resource),
+      hub_threshold(other.hub_threshold), vertex_order(other.vertex_order), weight_index(other.weight_index, resource),
+      weight_indexed(other.weight_indexed), properties(other.properties, resource) {}
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight>& BasicGraph<VertexId, Weight>::operator=(const BasicGraph& other) = default;
 
 // move конструктор
-Graph::Graph(Graph&& other) noexcept = default;
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight>::BasicGraph(BasicGraph&& other) noexcept = default;
 
 // move оператор присваивания
-Graph &Graph::operator=(Graph &&) noexcept = default;
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight> &BasicGraph<VertexId, Weight>::operator=(BasicGraph &&) = default;
 
 // деструктор
-Graph::~Graph() {}
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight>::~BasicGraph() {}
 
-void Graph::AddVertex(const int& v_num) {
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::AddVertex(const VertexId& v_num) {
     if (this->findVertex(v_num) != -1) {
         throw Exceptions("Вершина уже есть в графе\n");
     }
 
-    this->vertex.push_back(v_num);
-    int some_size = 15;
-    std::vector<Edge> for_new_v;
-    for_new_v.reserve(some_size);
-    this->edge.push_back(for_new_v);
-}
-
-void Graph::AddVertex(const int& v_num, std::vector<int>& edges) {
-    if (this->findVertex(v_num) != -1) {
-        throw Exceptions("Вершина уже есть в графе\n");
+    this->vertex_index.Mutable().Assign(v_num, this->vertex->size());
+    this->vertex.Mutable().push_back(v_num);
+    this->vertex_order.Reset();
+    if (detail::Properties* props = this->vertexProperties()) {
+        props->PushVertex();
     }
+    // у листьев и вершин малой степени полуребра помещаются во встроенный буфер списка, поэтому заранее ничего не выделяем
+    this->edge.emplace_back();
+}
 
-    this->vertex.push_back(v_num);
-    std::vector<Edge> for_new_v;
-    this->edge.push_back(for_new_v);
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::AddVertex(const VertexId& v_num, std::vector<VertexId>& edges) {
+    this->AddVertex(v_num);
+    this->edge.Mutable(this->edge.size() - 1).Reserve(edges.size());
     for (auto& edge : edges) {
         this->AddEdge(v_num, edge);
     }
 }
 
-void Graph::AddVertex(const int& v_num, const std::vector<int>& edges, const std::vector<int>& weights) {
-    if (this->findVertex(v_num) != -1) {
-        throw Exceptions("Вершина уже есть в графе\n");
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::RemoveVertex(const VertexId& v_num) {
+    int found = findVertex(v_num);
+    if (found == -1) {
+        throw Exceptions("Вершина нет в графе\n");
     }
-
-    this->vertex.push_back(v_num);
-    std::vector<Edge> for_new_v;
-    this->edge.push_back(for_new_v);
-    for (size_t i = 0; i < edges.size(); i++) {
-        this->AddEdge(v_num, edges[i], weights[i]);
+    uint32_t ind = found;
+
+    // сначала удаляем у соседей обратные полуребра, пока индексы вершин не сдвинулись; кусок самой вершины
+    // отделяем от копий графа заранее, чтобы изменение соседа из того же куска не скопировало его посреди обхода
+    detail::Properties* edge_props = this->edgeProperties();
+    for (auto& half : this->edge.Mutable(ind)) {
+        this->unindexEdge(ind, half.to, half);
+        if (edge_props) {
+            edge_props->EraseEdge(ind, half.to);
+        }
+        if (half.to != ind) {
+            this->edge.Mutable(half.to).Erase(findEdge(half.to, ind), this->hub_threshold);
+        }
     }
-}
 
-void Graph::RemoveVertex(const int& v_num) {
-    if (this->findVertex(v_num) == -1) {
-        throw Exceptions("Вершина нет в графе\n");
+    // затем ставим последнюю вершину на место удаленной
+    uint32_t last = this->vertex->size() - 1;
+    this->edge.Mutable(ind) = std::move(this->edge.Mutable(last));
+    this->edge.pop_back();
+    std::pmr::vector<VertexId>& ids = this->vertex.Mutable();
+    ids[ind] = ids[last];
+    ids.pop_back();
+    this->vertex_index.Mutable().Erase(v_num);
+    this->vertex_order.Reset();
+    if (detail::Properties* props = this->vertexProperties()) {
+        if (ind != last) {
+            props->MoveVertex(last, ind);
+        }
+        props->TruncateVertices(last);
     }
 
-    int ind = findVertex(v_num);
-    this->edge[ind].swap(this->edge[this->edge.size() - 1]);
-    for (auto& edge : this->edge[this->edge.size() - 1]) {
-        int ind_other = findVertex(edge.other_vertex);
-        int ind_e = findEdge(ind_other, v_num);
-        if (ind_e != -1) {
-            std::swap(this->edge[ind_other][ind_e], this->edge[ind_other][this->edge[ind_other].size() - 1]);
-            this->edge[ind_other].pop_back();
+    if (ind != last) {
+        if (edge_props) {
+            // у ребер переехавшей вершины меняется ключ в таблице слотов, сами слоты остаются на месте
+            for (auto& half : this->edge[ind]) {
+                uint32_t to = half.to == last ? ind : half.to;
+                edge_props->RekeyEdge(detail::Properties::EdgeKey(last, half.to), detail::Properties::EdgeKey(ind, to));
+            }
+        }
+        // у соседей переехавшей вершины полуребра все еще указывают на ее старый индекс, перенумеровываем их за O(deg)
+        this->vertex_index.Mutable().Assign(ids[ind], ind);
+        int loop = findEdge(ind, last);
+        if (loop != -1) {
+            this->edge.Mutable(ind).Relabel(loop, ind, this->hub_threshold);
+        }
+        for (auto& half : this->edge[ind]) {
+            if (half.to != ind) {
+                this->edge.Mutable(half.to).Relabel(findEdge(half.to, last), ind, this->hub_threshold);
+            }
         }
     }
-    this->edge.pop_back();
-
-    std::swap(this->vertex[ind], this->vertex[this->vertex.size() - 1]);
-    this->vertex.pop_back();
 }
 
-void Graph::AddEdge(const Edge& new_edge) {
-    if (this->findEdge(new_edge.from_vertex, new_edge.other_vertex) != -1) {
-        throw Exceptions("Ребро уже есть в графе\n");
-    }
-
+template <class VertexId, class Weight>
+BasicEdgeHandle<VertexId> BasicGraph<VertexId, Weight>::AddEdge(const Edge& new_edge) {
     int ind_v1 = findVertex(new_edge.from_vertex);
     int ind_v2 = findVertex(new_edge.other_vertex);
-
-    Edge new_e1(new_edge.from_vertex, new_edge.other_vertex, new_edge.weight);
-    this->edge[ind_v1].push_back(new_e1);
-
-    Edge new_e2(new_edge.other_vertex, new_edge.from_vertex, new_edge.weight);
-    this->edge[ind_v2].push_back(new_e2);
-}
-
-void Graph::AddEdge(const int& from_v, const int& to_v) {
-    if (this->findEdge(from_v, to_v) != -1) {
+    if (ind_v1 == -1 || ind_v2 == -1) {
+        throw Exceptions("Вершины нет в графе\n");
+    }
+    if (this->findEdge(ind_v1, ind_v2) != -1) {
         throw Exceptions("Ребро уже есть в графе\n");
     }
 
-    int ind_v1 = findVertex(from_v);
-    int ind_v2 = findVertex(to_v);
-
-    Edge new_e1(from_v, to_v);
-    this->edge[ind_v1].push_back(new_e1);
-
-    Edge new_e2(to_v, from_v);
-    this->edge[ind_v2].push_back(new_e2);
+    // петля хранится одним полуребром
+    size_t pos_v1 = this->edge.Mutable(ind_v1).Insert(makeHalf(ind_v2, new_edge), this->hub_threshold);
+    size_t pos_v2 = pos_v1;
+    if (ind_v1 != ind_v2) {
+        pos_v2 = this->edge.Mutable(ind_v2).Insert(makeHalf(ind_v1, new_edge), this->hub_threshold);
+    }
+    this->indexEdge(ind_v1, ind_v2, makeHalf(ind_v2, new_edge));
+    if (detail::Properties* props = this->edgeProperties()) {
+        props->PushEdge(ind_v1, ind_v2);
+    }
+    return EdgeHandle(new_edge.from_vertex, new_edge.other_vertex, ind_v1, ind_v2, pos_v1, pos_v2);
 }
 
-void Graph::AddEdge(const int& from_v, const int& to_v, const int& weight) {
-    if (this->findEdge(from_v, to_v) != -1) {
-        throw Exceptions("Ребро уже есть в графе\n");
-    }
+template <class VertexId, class Weight>
+BasicEdgeHandle<VertexId> BasicGraph<VertexId, Weight>::AddEdge(const VertexId& from_v, const VertexId& to_v) {
+    return this->AddEdge(Edge(from_v, to_v));
+}
 
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::RemoveEdge(const VertexId& from_v, const VertexId& to_v) {
     int ind_v1 = findVertex(from_v);
     int ind_v2 = findVertex(to_v);
+    int pos_v1 = (ind_v1 == -1 || ind_v2 == -1) ? -1 : this->findEdge(ind_v1, ind_v2);
+    if (pos_v1 == -1) {
+        throw Exceptions("Ребра нет в графе\n");
+    }
+    this->eraseEdge(ind_v1, ind_v2, pos_v1, findEdge(ind_v2, ind_v1));
+}
 
-    Edge new_e1(from_v, to_v, weight);
-    this->edge[ind_v1].push_back(new_e1);
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::RemoveEdge(const EdgeHandle& handle) {
+    EdgeHandle h = this->resolve(handle);
+    this->eraseEdge(h.from, h.to, h.from_pos, h.to_pos);
+}
 
-    Edge new_e2(to_v, from_v, weight);
-    this->edge[ind_v2].push_back(new_e2);
+template <class VertexId, class Weight>
+BasicEdgeHandle<VertexId> BasicGraph<VertexId, Weight>::FindEdgeHandle(const VertexId& from_v, const VertexId& to_v) const {
+    // индекс за пределами графа заставляет resolve найти вершины по номерам
+    uint32_t outside = this->vertex->size();
+    return this->resolve(EdgeHandle(from_v, to_v, outside, outside, 0, 0));
 }
 
-void Graph::RemoveEdge(const int& from_v, const int& to_v) {
-    if (this->findEdge(this->findVertex(from_v), to_v) == -1) {
+template <class VertexId, class Weight>
+BasicEdgeHandle<VertexId> BasicGraph<VertexId, Weight>::resolve(const EdgeHandle& handle) const {
+    if (handle.from == EdgeHandle::kUnbound) {
         throw Exceptions("Ребра нет в графе\n");
     }
+    EdgeHandle h = handle;
+    size_t n = this->vertex->size();
+    if (h.from >= n || h.to >= n || (*this->vertex)[h.from] != h.from_vertex || (*this->vertex)[h.to] != h.other_vertex) {
+        int ind_v1 = this->findVertex(h.from_vertex);
+        int ind_v2 = this->findVertex(h.other_vertex);
+        if (ind_v1 == -1 || ind_v2 == -1) {
+            throw Exceptions("Ребра нет в графе\n");
+        }
+        h.from = ind_v1;
+        h.to = ind_v2;
+    }
+    auto fix = [&](uint32_t from, uint32_t to, uint32_t& pos) {
+        const List& list = this->edge[from];
+        if (pos >= list.size() || list[pos].to != to) {
+            int found = this->findEdge(from, to);
+            if (found == -1) {
+                throw Exceptions("Ребра нет в графе\n");
+            }
+            pos = found;
+        }
+    };
+    fix(h.from, h.to, h.from_pos);
+    fix(h.to, h.from, h.to_pos);
+    return h;
+}
 
-    int ind_v1 = findVertex(from_v);
-    int ind_v2 = findVertex(to_v);
-
-    int ind_e1 = findEdge(ind_v1, to_v);
-    std::swap(this->edge[ind_v1][ind_e1], this->edge[ind_v1][this->edge[ind_v1].size() - 1]);
-    this->edge[ind_v1].pop_back();
-
-    int ind_e2 = findEdge(ind_v2, from_v);
-    std::swap(this->edge[ind_v2][ind_e2], this->edge[ind_v2][this->edge[ind_v2].size() - 1]);
-    this->edge[ind_v2].pop_back();
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::eraseEdge(uint32_t from, uint32_t to, size_t from_pos, size_t to_pos) {
+    this->unindexEdge(from, to, this->edge[from][from_pos]);
+    if (detail::Properties* props = this->edgeProperties()) {
+        props->EraseEdge(from, to);
+    }
+    // списки разные, поэтому удаление из одного не сдвигает полуребро в другом; петля хранится одним полуребром
+    this->edge.Mutable(from).Erase(from_pos, this->hub_threshold);
+    if (from != to) {
+        this->edge.Mutable(to).Erase(to_pos, this->hub_threshold);
+    }
 }
 
-int Graph::Size() {
-    return this->vertex.size();
+template <class VertexId, class Weight>
+int BasicGraph<VertexId, Weight>::Size() const noexcept {
+    return this->vertex->size();
 }
 
-std::vector<Edge> Graph::AllEdges() {
+template <class VertexId, class Weight>
+std::vector<BasicEdge<VertexId, Weight>> BasicGraph<VertexId, Weight>::AllEdges() const {
     std::vector<Edge> allEdges;
 
-    std::sort(this->vertex.begin(), this->vertex.end());
+    for (const Edge& e : this->Edges(EdgeOrder::ByVertex)) {
+        if (e.from_vertex != e.other_vertex) {
+            allEdges.push_back(e);
+        }
+    }
+
+    return allEdges;
+}
 
-    for (size_t i = 0; i < this->vertex.size(); i++) {
-        for (size_t j = 0; j < this->edge[i].size(); j++) {
-            if (this->edge[i][j].from_vertex < this->edge[i][j].other_vertex) {
-                allEdges.push_back(this->edge[i][j]);
+template <class VertexId, class Weight>
+EdgeRange<VertexId, Weight, BasicEdge<VertexId, Weight>> BasicGraph<VertexId, Weight>::Edges(EdgeOrder order) const {
+    std::shared_ptr<const std::vector<uint32_t>> perm;
+    if (order == EdgeOrder::ByVertex) {
+        // готовая перестановка читается без блокировок, одной атомарной загрузкой
+        perm = this->vertex_order.Get();
+        if (!perm) {
+            // сам граф не трогаем: сортируем перестановку индексов и публикуем ее в кэш; если несколько читателей
+            // посчитали ее одновременно, все варианты одинаковы и в кэше останется любой из них
+            auto sorted = std::make_shared<std::vector<uint32_t>>(this->vertex->size());
+            for (size_t i = 0; i < sorted->size(); i++) {
+                (*sorted)[i] = i;
             }
+            std::sort(sorted->begin(), sorted->end(), [&](uint32_t a, uint32_t b) {
+                return (*this->vertex)[a] < (*this->vertex)[b];
+            });
+            perm = this->vertex_order.Publish(std::move(sorted));
         }
     }
+    return EdgeRange<VertexId, Weight, Edge>(&this->edge, this->vertex->data(), this->vertex->size(), std::move(perm));
+}
 
-    return allEdges;
+template <class VertexId, class Weight>
+std::vector<VertexId> BasicGraph<VertexId, Weight>::AllVertex() const {
+    return std::vector<VertexId>(this->vertex->begin(), this->vertex->end());
+}
+
+template <class VertexId, class Weight>
+NeighborRange<VertexId, Weight> BasicGraph<VertexId, Weight>::Neighbors(const VertexId& v_num) const {
+    int ind = this->findVertex(v_num);
+    if (ind == -1) {
+        throw Exceptions("Вершина нет в графе\n");
+    }
+    return NeighborRange<VertexId, Weight>(this->edge[ind].begin(), this->edge[ind].end(), this->vertex->data());
+}
+
+template <class VertexId, class Weight>
+size_t BasicGraph<VertexId, Weight>::Degree(const VertexId& v_num) const {
+    int ind = this->findVertex(v_num);
+    if (ind == -1) {
+        throw Exceptions("Вершина нет в графе\n");
+    }
+    return this->edge[ind].size();
 }
 
-std::vector<int> Graph::AllVertex() {
-    return this->vertex;
+template <class VertexId, class Weight>
+bool BasicGraph<VertexId, Weight>::HasVertex(const VertexId& v_num) const noexcept {
+    return this->findVertex(v_num) != -1;
 }
 
-std::istream& Graph::ReadFrom(std::istream& in) {
-    Graph new_graph;
+template <class VertexId, class Weight>
+bool BasicGraph<VertexId, Weight>::HasEdge(const VertexId& from_v, const VertexId& to_v) const noexcept {
+    int ind_v1 = this->findVertex(from_v);
+    int ind_v2 = this->findVertex(to_v);
+    return ind_v1 != -1 && ind_v2 != -1 && this->findEdge(ind_v1, ind_v2) != -1;
+}
+
+template <class VertexId, class Weight>
+std::pmr::memory_resource* BasicGraph<VertexId, Weight>::Resource() const noexcept {
+    return this->edge.Resource();
+}
+
+template <class VertexId, class Weight>
+std::istream& BasicGraph<VertexId, Weight>::ReadFrom(std::istream& in) {
+    BasicGraph new_graph(this->Resource());
+    // прочитанные списки смежности становятся хабами по порогу этого графа, а не по порогу по умолчанию
+    new_graph.hub_threshold = this->hub_threshold;
 
     std::string str_title;
     in >> str_title;
@@ -184,9 +360,14 @@ std::istream& Graph::ReadFrom(std::istream& in) {
 
     int size;
     in >> size;
-    this->vertex.reserve(size);
-    for (size_t i = 0; i < size; i++) {
-        int v_num;
+    if (size < 0) {
+        in.setstate(std::ios_base::failbit);
+        return in;
+    }
+    new_graph.vertex.Mutable().reserve(size);
+    new_graph.vertex_index.Mutable().Reserve(size);
+    for (int i = 0; i < size; i++) {
+        VertexId v_num;
         in >> v_num;
         if (v_num < 0) {
             in.setstate(std::ios_base::failbit);
@@ -213,18 +394,31 @@ std::istream& Graph::ReadFrom(std::istream& in) {
 
     int size_e;
     in >> size_e;
-    for (size_t j = 0; j < size_e; j++) {
+    for (int j = 0; j < size_e; j++) {
         if (weight) {
-            int v_from, v_to, weight;
-            in >> v_from >> v_to >> weight;
-            if (v_from < 0 || v_to < 0 || weight < 1) {
-                in.setstate(std::ios_base::failbit);
-                return in;
-            }
+            VertexId v_from, v_to;
+            if constexpr (std::is_void_v<Weight>) {
+                // невзвешенный граф читает взвешенный формат, отбрасывая веса
+                std::string ignored;
+                in >> v_from >> v_to >> ignored;
+                if (v_from < 0 || v_to < 0) {
+                    in.setstate(std::ios_base::failbit);
+                    return in;
+                }
 
-            new_graph.AddEdge(v_from, v_to, weight);
+                new_graph.AddEdge(v_from, v_to);
+            } else {
+                Weight weight;
+                in >> v_from >> v_to >> weight;
+                if (v_from < 0 || v_to < 0 || !(weight > Weight(0))) {
+                    in.setstate(std::ios_base::failbit);
+                    return in;
+                }
+
+                new_graph.AddEdge(v_from, v_to, weight);
+            }
         } else {
-            int v_from, v_to;
+            VertexId v_from, v_to;
             in >> v_from >> v_to;
             if (v_from < 0 || v_to < 0) {
                 in.setstate(std::ios_base::failbit);
@@ -235,22 +429,41 @@ std::istream& Graph::ReadFrom(std::istream& in) {
         }
     }
 
-    *this = new_graph;
+    bool indexed = this->weight_indexed;
+    *this = std::move(new_graph);
+    if (indexed) {
+        // прочитанный граф заменяет старый целиком, индекс весов строится заново за один проход
+        this->buildWeightIndex();
+    }
     return in;
 }
 
-std::ostream& Graph::WriteTo(std::ostream& out) const {
-    out << "vertex:\n" << this->vertex.size() << '\n';
-    for (size_t i = 0; i < this->vertex.size(); i++) {
-        out << this->vertex[i] << ' ';
+template <class VertexId, class Weight>
+std::ostream& BasicGraph<VertexId, Weight>::WriteTo(std::ostream& out) const {
+    out << "vertex:\n" << this->vertex->size() << '\n';
+    for (size_t i = 0; i < this->vertex->size(); i++) {
+        out << (*this->vertex)[i] << ' ';
     }
     out << '\n';
 
-    out << "edge\n";
-    for (size_t i = 0; i < this->vertex.size(); i++) {
-        for (size_t j = 0; j < this->edge[i].size(); j++) {
-            if (this->edge[i][j].from_vertex < this->edge[i][j].other_vertex) {
-                out << this->edge[i][j].from_vertex << ' ' << this->edge[i][j].other_vertex << ' ' << this->edge[i][j].weight << '\n';
+    out << (std::is_void_v<Weight> ? "NotWeight\n" : "Weight\n");
+
+    // каждое ребро пишется один раз, петли тоже, чтобы граф читался обратно без потерь
+    size_t size_e = 0;
+    for (size_t i = 0; i < this->vertex->size(); i++) {
+        for (auto& half : this->edge[i]) {
+            size_e += (*this->vertex)[i] <= (*this->vertex)[half.to];
+        }
+    }
+    out << "edge:\n" << size_e << '\n';
+    for (size_t i = 0; i < this->vertex->size(); i++) {
+        for (auto& half : this->edge[i]) {
+            if ((*this->vertex)[i] <= (*this->vertex)[half.to]) {
+                out << (*this->vertex)[i] << ' ' << (*this->vertex)[half.to];
+                if constexpr (!std::is_void_v<Weight>) {
+                    out << ' ' << half.weight;
+                }
+                out << '\n';
             }
         }
     }
@@ -258,35 +471,180 @@ std::ostream& Graph::WriteTo(std::ostream& out) const {
     return out;
 }
 
-int Graph::findVertex(const int& v_num) const {
-    for (size_t i = 0; i < this->vertex.size(); i++) {
-        if (vertex[i] == v_num) {
-            return i;
+template <class VertexId, class Weight>
+int BasicGraph<VertexId, Weight>::findVertex(const VertexId& v_num) const noexcept {
+    uint32_t ind = this->vertex_index->Find(v_num);
+    if (ind == HashIndex<VertexId>::kNotFound) {
+        return -1;
+    }
+    return ind;
+}
+
+template <class VertexId, class Weight>
+int BasicGraph<VertexId, Weight>::findEdge(const int& from_ind, const int& to_ind) const noexcept {
+    return this->edge[from_ind].Find(to_ind);
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::SetHubThreshold(size_t threshold) {
+    this->hub_threshold = threshold;
+    for (size_t i = 0; i < this->edge.size(); i++) {
+        this->edge.Mutable(i).Rebalance(threshold);
+    }
+}
+
+template <class VertexId, class Weight>
+size_t BasicGraph<VertexId, Weight>::HubThreshold() const {
+    return this->hub_threshold;
+}
+
+template <class VertexId, class Weight>
+bool BasicGraph<VertexId, Weight>::RemoveVertexProperty(std::string_view name) {
+    return this->properties->Contains(false, name) && this->properties.Mutable().Remove(false, name);
+}
+
+template <class VertexId, class Weight>
+bool BasicGraph<VertexId, Weight>::RemoveEdgeProperty(std::string_view name) {
+    return this->properties->Contains(true, name) && this->properties.Mutable().Remove(true, name);
+}
+
+template <class VertexId, class Weight>
+size_t BasicGraph<VertexId, Weight>::VertexSlot(const VertexId& v_num) const {
+    int ind = this->findVertex(v_num);
+    if (ind == -1) {
+        throw Exceptions("Вершина нет в графе\n");
+    }
+    return ind;
+}
+
+template <class VertexId, class Weight>
+size_t BasicGraph<VertexId, Weight>::EdgeSlot(const VertexId& from_v, const VertexId& to_v) const {
+    int ind_v1 = this->findVertex(from_v);
+    int ind_v2 = this->findVertex(to_v);
+    uint32_t slot = HashIndex<uint64_t>::kNotFound;
+    if (ind_v1 != -1 && ind_v2 != -1) {
+        slot = this->properties->FindEdge(ind_v1, ind_v2);
+    }
+    if (slot == HashIndex<uint64_t>::kNotFound) {
+        throw Exceptions("Ребра нет в графе\n");
+    }
+    return slot;
+}
+
+template <class VertexId, class Weight>
+BasicEdge<VertexId, Weight> BasicGraph<VertexId, Weight>::SlotEdge(size_t slot) const {
+    uint64_t key = this->properties->KeyAt(slot);
+    uint32_t from = key >> 32;
+    uint32_t to = static_cast<uint32_t>(key);
+    VertexId from_v = (*this->vertex)[from];
+    VertexId to_v = (*this->vertex)[to];
+    return makeEdge(std::min(from_v, to_v), std::max(from_v, to_v), this->edge[from][this->findEdge(from, to)]);
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::fillEdgeSlots(detail::Properties& props) const {
+    for (size_t i = 0; i < this->edge.size(); i++) {
+        for (auto& half : this->edge[i]) {
+            if (i <= half.to) {
+                props.PushEdge(i, half.to);
+            }
+        }
+    }
+}
+
+template <class VertexId, class Weight>
+detail::Properties* BasicGraph<VertexId, Weight>::vertexProperties() {
+    return this->properties->Empty() ? nullptr : &this->properties.Mutable();
+}
+
+template <class VertexId, class Weight>
+detail::Properties* BasicGraph<VertexId, Weight>::edgeProperties() {
+    return this->properties->HasEdgeColumns() ? &this->properties.Mutable() : nullptr;
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::DisableWeightIndex() {
+    this->weight_index = decltype(this->weight_index)(this->Resource());
+    this->weight_indexed = false;
+}
+
+template <class VertexId, class Weight>
+bool BasicGraph<VertexId, Weight>::HasWeightIndex() const noexcept {
+    return this->weight_indexed;
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::buildWeightIndex() {
+    if constexpr (!std::is_void_v<Weight>) {
+        this->weight_index.Reset();
+        this->weight_indexed = true;
+        this->builtWeightIndex();
+    }
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::fillWeightIndex(detail::WeightIndex<VertexId, Weight>& index) const {
+    if constexpr (!std::is_void_v<Weight>) {
+        using Key = detail::WeightKey<VertexId, Weight>;
+        std::vector<Key> keys;
+        for (const Edge& e : this->Edges()) {
+            keys.push_back({e.weight, std::min(e.from_vertex, e.other_vertex), std::max(e.from_vertex, e.other_vertex)});
+        }
+        std::sort(keys.begin(), keys.end());
+
+        // записи вставляются по возрастанию с подсказкой end(), поэтому каждая вставка стоит O(1)
+        for (const Key& key : keys) {
+            index.insert(index.end(), key);
+        }
+    } else {
+        (void)index;
+    }
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::indexEdge(uint32_t from, uint32_t to, const Half& half) {
+    if constexpr (!std::is_void_v<Weight>) {
+        // разделяемый индекс не копируется: Exclusive его отпускает, и он строится заново при следующем запросе
+        if (auto* index = this->weight_index.Exclusive()) {
+            VertexId from_v = (*this->vertex)[from];
+            VertexId to_v = (*this->vertex)[to];
+            index->insert({half.weight, std::min(from_v, to_v), std::max(from_v, to_v)});
         }
     }
-    return -1;
 }
 
-int Graph::findEdge(const int& from_ind, const int& to_num) const {
-    for (int i = 0; i < this->edge[from_ind].size(); i++) {
-        if (this->edge[from_ind][i].other_vertex == to_num) {
-            return i;
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::unindexEdge(uint32_t from, uint32_t to, const Half& half) {
+    if constexpr (!std::is_void_v<Weight>) {
+        if (auto* index = this->weight_index.Exclusive()) {
+            VertexId from_v = (*this->vertex)[from];
+            VertexId to_v = (*this->vertex)[to];
+            index->erase({half.weight, std::min(from_v, to_v), std::max(from_v, to_v)});
         }
     }
-    return -1;
 }
 
-void Graph::ShowGraph(std::string file_name) const {
+template <class VertexId, class Weight>
+size_t BasicGraph<VertexId, Weight>::listGrain(size_t grain) const {
+    return detail::IsConcurrentResource(this->Resource()) ? grain : SIZE_MAX;
+}
+
+template <class VertexId, class Weight>
+void BasicGraph<VertexId, Weight>::ShowGraph(std::string file_name) const {
     std::ofstream out;          // поток для записи
     out.open(file_name); // окрываем файл для записи
     if (out.is_open())
     {
         out << "```mermaid\n";
         out << " flowchart LR;\n";
-        for (size_t i = 0; i < this->vertex.size(); i++) {
-            for (size_t j = 0; j < this->edge[i].size(); j++) {
-                if (this->edge[i][j].from_vertex < this->edge[i][j].other_vertex) {
-                    out << '\t' << this->edge[i][j].from_vertex << "-- " << this->edge[i][j].weight << " ---" << this->edge[i][j].other_vertex << ";\n";
+        for (size_t i = 0; i < this->vertex->size(); i++) {
+            for (auto& half : this->edge[i]) {
+                if ((*this->vertex)[i] < (*this->vertex)[half.to]) {
+                    if constexpr (std::is_void_v<Weight>) {
+                        out << '\t' << (*this->vertex)[i] << " --- " << (*this->vertex)[half.to] << ";\n";
+                    } else {
+                        out << '\t' << (*this->vertex)[i] << "-- " << half.weight << " ---" << (*this->vertex)[half.to] << ";\n";
+                    }
                 }
             }
         }
@@ -295,10 +653,6 @@ void Graph::ShowGraph(std::string file_name) const {
     out.close();
 }
 
-std::istream& operator>>(std::istream& in, Graph& gr) {
-    return gr.ReadFrom(in);
-}
-
-std::ostream& operator<<(std::ostream& out, Graph& gr) {
-    return gr.WriteTo(out);
-}
\ No newline at end of file
+#define INSTANTIATE(VertexId, Weight) template class BasicGraph<VertexId, Weight>;
+GRAPH_FOR_EACH_INSTANCE(INSTANTIATE)
+#undef INSTANTIATE
\ No newline at end of file
@@ -19,50 +19,215 @@
 #include <algorithm>
 #include <map>
 #include <fstream>
+#include <functional>
+#include <memory_resource>
+#include <type_traits>
+#include <cstdint>
 
+#include "adjacency.h"
+#include "cow.h"
+#include "edge_range.h"
+#include "hash_index.h"
+#include "neighbors.h"
+#include "properties.h"
+#include "weight_index.h"
+
+template <class VertexId, class Weight>
+class BasicFrozenGraph;
+template <class Graph>
+class SubgraphView;
 
 /*!
-    \brief Класс Edge реализует ребра графа.
-    \details Каждый объект класса Edge хранит в себе следующую информацию:
+    \brief Класс BasicEdge реализует ребра графа.
+    \details Каждый объект класса BasicEdge хранит в себе следующую информацию:
     * from_vertex - одна из вершин ребра
     * other_vertex - другая вершина ребра
     * weight - вес ребра
 */
-class Edge {
+template <class VertexId, class Weight>
+class BasicEdge {
+public:
+    VertexId from_vertex;
+    VertexId other_vertex;
+    Weight weight = 1;
+
+    BasicEdge() = default;
+    BasicEdge(VertexId from_v, VertexId to_v) : from_vertex(from_v), other_vertex(to_v) {}
+    BasicEdge(VertexId from_v, VertexId to_v, Weight weight) : from_vertex(from_v), other_vertex(to_v), weight(weight) {}
+};
+
+/*!
+    \brief Ребро невзвешенного графа: только две вершины, без веса
+*/
+template <class VertexId>
+class BasicEdge<VertexId, void> {
+public:
+    VertexId from_vertex;
+    VertexId other_vertex;
+
+    BasicEdge() = default;
+    BasicEdge(VertexId from_v, VertexId to_v) : from_vertex(from_v), other_vertex(to_v) {}
+};
+
+/*!
+    \brief Класс BasicEdgeHandle - ручка ребра графа, по которой ребро удаляется или меняет вес без поиска вершин.
+    \details Ручка запоминает номера концов ребра, их внутренние индексы и позиции полуребер в списках смежности
+    обоих концов. Граф проверяет ее за O(1): стоит ли по запомненному индексу та же вершина и лежит ли по запомненной
+    позиции полуребро к тому же соседу. Если вершина переехала (RemoveVertex) или полуребро сдвинулось (вставка или
+    удаление в том же списке), граф находит ребро заново по номерам вершин, поэтому ручка действительна, пока ребро
+    есть в графе, и в любой копии графа.
+    * from_vertex, other_vertex - номера концов ребра
+    * from, to - внутренние индексы концов ребра; kUnbound у ручки, созданной по умолчанию
+    * from_pos, to_pos - позиции полуребер в списках смежности from и to
+*/
+template <class VertexId>
+class BasicEdgeHandle {
 public:
-    int from_vertex;
-    int other_vertex;
-    int weight = 1;
+    BasicEdgeHandle() = default;
+
+    const VertexId& From() const noexcept {
+        return this->from_vertex;
+    }
+    const VertexId& To() const noexcept {
+        return this->other_vertex;
+    }
+
+private:
+    template <class V, class W>
+    friend class BasicGraph;
+
+    static constexpr uint32_t kUnbound = UINT32_MAX;
+
+    BasicEdgeHandle(const VertexId& from_v, const VertexId& to_v, uint32_t from, uint32_t to, uint32_t from_pos, uint32_t to_pos)
+        : from_vertex(from_v), other_vertex(to_v), from(from), to(to), from_pos(from_pos), to_pos(to_pos) {}
+
+    VertexId from_vertex{};
+    VertexId other_vertex{};
+    uint32_t from = kUnbound;
+    uint32_t to = kUnbound;
+    uint32_t from_pos = 0;
+    uint32_t to_pos = 0;
+};
 
-    Edge() = default;
-    Edge(int from_v, int to_v) : from_vertex(from_v), other_vertex(to_v) {}
-    Edge(int from_v, int to_v, int weight) : from_vertex(from_v), other_vertex(to_v), weight(weight) {}
+/*!
+    \brief Что делать с повторяющимися ребрами при построении графа из списка ребер.
+    * Reject - бросить исключение, как это делает AddEdge
+    * Drop - оставить только первое вхождение ребра в списке, остальные молча отбросить
+*/
+enum class DuplicateEdges {
+    Reject,
+    Drop
+};
+
+/*!
+    \brief Каким алгоритмом искать минимальное остовное дерево.
+    * Auto - выбрать по графу: Краскал по индексу весов, если он построен, иначе Прим на плотных графах,
+      а на разреженных Борувка, если ребер хватает на несколько потоков, а если нет - Краскал для целых весов
+      и Filter-Kruskal для остальных
+    * Kruskal - алгоритм Краскала: сортировка ребер по весу и система непересекающихся множеств, O(E log E);
+      целые веса сортируются поразрядно, по одному проходу O(E) на каждый байт разброса весов
+    * Prim - алгоритм Прима на индексированной d-арной куче с d порядка E / V, O(E log_d V); на плотном графе
+      это почти O(E), и ребра не сортируются
+    * FilterKruskal - Краскал, который делит ребра опорным ребром и отбрасывает тяжелые ребра, замкнутые легкими,
+      не сортируя их; дерево совпадает с деревом Краскала
+    * Boruvka - параллельный алгоритм Борувки, O(E log V) работы за O(log V) раундов; дерево не зависит
+      от количества потоков и совпадает с деревом Краскала
+*/
+enum class MstAlgorithm {
+    Auto,
+    Kruskal,
+    Prim,
+    FilterKruskal,
+    Boruvka
+};
+
+/*!
+    \brief Какие номера вершин получает извлеченный подграф.
+    * Keep - те же, что в исходном графе
+    * Renumber - 0..k-1 в порядке хранения исходного графа, то есть в порядке AllVertex()
+*/
+enum class SubgraphIds {
+    Keep,
+    Renumber
 };
 
 /*!
-    \brief Класс Graph основной класс реализующий граф, поддерживающий добавление и удаление вершин и ребер, то есть способный динамически изменяться.
-    \details Каждый объект класса Graph хранит в себе следующую информацию:
-    * vertex - std::vector<int> с вершинами графа
-    * edge - std::vector<std::vector<Edge>> матрица смежности графа, то есть множество ребер графа
+    \brief Класс BasicGraph основной класс реализующий граф, поддерживающий добавление и удаление вершин и ребер, то есть способный динамически изменяться.
+    \details Параметры шаблона:
+    * VertexId - целочисленный тип номеров вершин
+    * Weight - тип веса ребер; void - невзвешенный граф, который не хранит весов вовсе (полуребро занимает 4 байта),
+      а выбор между взвешенными и невзвешенными алгоритмами делается при компиляции.
+    Библиотека собрана для VertexId из {int, int64_t} и Weight из {int, int64_t, float, double, void}
+    (см. GRAPH_FOR_EACH_INSTANCE); Graph - это BasicGraph<int, int>.
+
+    Каждый объект класса BasicGraph хранит в себе следующую информацию:
+    * vertex - std::pmr::vector<VertexId> с вершинами графа, то есть таблица перевода внутреннего индекса вершины в ее номер
+    * edge - списки смежности графа, то есть множество ребер графа, разбитые на куски по 256 вершин (см. CowChunks)
+    * vertex_index - хеш-индекс номер вершины -> индекс в vertex и edge, поиск вершины за O(1) в среднем
+    * hub_threshold - степень, после которой список смежности вершины получает хеш-индекс (см. AdjacencyList)
+    * vertex_order - кэш перестановки внутренних индексов по возрастанию номеров вершин для Edges(EdgeOrder::ByVertex);
+      заполняется лениво константными методами, читается без блокировок (см. LazyCache) и сбрасывается при изменении
+      множества вершин
+    * weight_index - необязательный индекс ребер по весу (см. EnableWeightIndex), есть только у взвешенного графа
+    * weight_indexed - включен ли индекс весов; сам индекс может быть еще не построен (см. LazyWeightIndex)
+    * properties - столбцы свойств вершин и ребер (см. VertexProperty, EdgeProperty)
+
+    Внутри графа вершины пронумерованы плотно индексами 0..n-1, и списки смежности хранят именно индексы соседей,
+    поэтому переход к соседу - это обращение к массиву. Номера вершин используются только на границе API.
+
+    Вся память графа (массивы вершин, списки смежности, хеш-индексы) берется из std::pmr::memory_resource,
+    переданного в конструктор, по умолчанию - из std::pmr::get_default_resource(). Копия графа, как и копия
+    любого std::pmr контейнера, использует ресурс по умолчанию. Готовые ресурсы - GraphArena и AdjacencyPool (arena.h).
+
+    Копии графа с равными ресурсами разделяют данные до первого изменения (copy-on-write): копирование стоит
+    O(V / 256), изменение ребра копирует только кусок списков смежности со своими вершинами, а таблица вершин
+    и хеш-индекс копируются целиком при первом изменении множества вершин. Изменения одной копии никогда не видны
+    в другой; единственное условие - не писать в столбец MutableVertexProperty или MutableEdgeProperty, взятый
+    до копирования.
 */
-class Graph {
+template <class VertexId, class Weight>
+class BasicGraph {
 public:
+    using Edge = BasicEdge<VertexId, Weight>;
+    using FrozenGraph = BasicFrozenGraph<VertexId, Weight>;
+    using Neighbor = BasicNeighbor<VertexId, Weight>;
+    using EdgeHandle = BasicEdgeHandle<VertexId>;
+
     // конструкторы
-    Graph() = default;
+    BasicGraph() = default;
+    /*!
+     * Создает пустой граф, вся память которого берется из resource
+     * @param resource источник памяти; должен жить дольше графа
+     */
+    explicit BasicGraph(std::pmr::memory_resource* resource);
     /*!
      * Создает объект класса Graph
      * @param edge список ребер, которые задают граф
+     * @param duplicates что делать с повторяющимися ребрами
+     * @param resource источник памяти графа; должен жить дольше графа
+     * @throw std::exception Если в списке есть повторяющееся ребро, а duplicates == DuplicateEdges::Reject
+     * @note Граф строится целиком за один проход: номера вершин сортируются поразрядной сортировкой,
+     * степени считаются заранее, и каждый список смежности резервируется точно под свой размер.
+     * Вершины получают внутренние индексы в порядке возрастания номеров.
      */
-    Graph(const std::vector<Edge>& edge);
+    BasicGraph(const std::vector<Edge>& edge, DuplicateEdges duplicates = DuplicateEdges::Reject,
+               std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     // копирование
-    Graph(const Graph& other);
-    Graph& operator=(const Graph& other);
+    BasicGraph(const BasicGraph& other);
+    /*!
+     * Копирует граф в другой источник памяти; если ресурсы равны, копия разделяет данные с оригиналом
+     * @param other исходный граф
+     * @param resource источник памяти копии; должен жить дольше копии
+     */
+    BasicGraph(const BasicGraph& other, std::pmr::memory_resource* resource);
+    BasicGraph& operator=(const BasicGraph& other);
     // move конструктор
-    Graph(Graph&& other) noexcept;
-    // move оператор присваивания
-    Graph& operator=(Graph&& other) noexcept;
+    BasicGraph(BasicGraph&& other) noexcept;
+    // move оператор присваивания; данные забираются без выделений, если ресурсы графов равны, иначе копируются
+    // в ресурс этого графа, поэтому присваивание может бросить std::bad_alloc
+    BasicGraph& operator=(BasicGraph&& other);
     // деструктор
-    ~Graph();
+    ~BasicGraph();
 
 
     // добавление/удаление вершины
@@ -71,84 +236,468 @@ public:
      * @param v_num номер вершины
      * @throw std::exception Если вершина, которую хотим добавить, уже есть в графе
      */
-    void AddVertex(const int& v_num);
+    void AddVertex(const VertexId& v_num);
     /*!
      * Добавляет в граф вершину и её ребра. Необходимо, чтобы все вершины в списке уже находились в графе
      * @param v_num номер вершины
      * @param edges список смежных вершин
      * @throw std::exception Если вершина, которую хотим добавить, уже есть в графе
      */
-    void AddVertex(const int& v_num, std::vector<int> &edges);
+    void AddVertex(const VertexId& v_num, std::vector<VertexId> &edges);
     /*!
      * Добавляет в граф вершину и её ребра с весами. Необходимо, чтобы все вершины в списке уже находились в графе
      * @param v_num номер вершины
      * @param edges список смежных вершин
      * @param weights список весов ребер
      * @throw std::exception Если вершина, которую хотим добавить, уже есть в графе
+     * @note Есть только у взвешенного графа
      */
-    void AddVertex(const int& v_num, const std::vector<int>&edges, const std::vector<int> &weights);
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    void AddVertex(const VertexId& v_num, const std::vector<VertexId>& edges, const std::vector<W>& weights) {
+        this->AddVertex(v_num);
+        this->edge.Mutable(this->edge.size() - 1).Reserve(edges.size());
+        for (size_t i = 0; i < edges.size(); i++) {
+            this->AddEdge(Edge(v_num, edges[i], weights[i]));
+        }
+    }
     /*!
      * Удаляет вершину из графа вместе со всеми её ребрами
      * @param v_num номер вершины
      * @throw std::exception Если в графе нет вершины, которую хотим удалить
      */
-    void RemoveVertex(const int& v_num);
+    void RemoveVertex(const VertexId& v_num);
 
 
     // добавление/удаление ребра
     /*!
      * Добавляет указанное ребро в граф
      * @param new_edge ребро, которое нужно добавить в граф
+     * @return Ручка ребра для RemoveEdge и SetWeight; ее можно не сохранять
      * @throw std::exception Если ребро, которое хотим добавить, уже есть в графе
      */
-    void AddEdge(const Edge& new_edge);
+    EdgeHandle AddEdge(const Edge& new_edge);
     /*!
-     * Добавляет в граф ребро между вершинами
+     * Добавляет в граф ребро между вершинами; у взвешенного графа вес ребра равен 1
      * @param from_v одна из вершин ребра
      * @param to_v другая вершина ребра
+     * @return Ручка ребра для RemoveEdge и SetWeight; ее можно не сохранять
      * @throw std::exception Если ребро, которое хотим добавить, уже есть в графе
      */
-    void AddEdge(const int& from_v, const int& to_v);
+    EdgeHandle AddEdge(const VertexId& from_v, const VertexId& to_v);
     /*!
      * Добавляет в граф ребро с указанным весом между вершинами
      * @param from_v одна из вершин ребра
      * @param to_v другая вершина ребра
      * @param weight вес ребра
+     * @return Ручка ребра для RemoveEdge и SetWeight; ее можно не сохранять
      * @throw std::exception Если ребро, которое хотим добавить, уже есть в графе
+     * @note Есть только у взвешенного графа
      */
-    void AddEdge(const int& from_v, const int& to_v, const int& weight);
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    EdgeHandle AddEdge(const VertexId& from_v, const VertexId& to_v, const W& weight) {
+        return this->AddEdge(Edge(from_v, to_v, weight));
+    }
     /*!
      * Удаляет ребро между двумя вершинами
      * @param from_v одна из вершин ребра
      * @param to_v другая вершина ребра
      * @throw std::exception Если в графе нет ребра, которое хотим удалить
      */
-    void RemoveEdge(const int& from_v, const int& to_v);
+    void RemoveEdge(const VertexId& from_v, const VertexId& to_v);
+    /*!
+     * Удаляет ребро по ручке за O(1), если ручка не устарела, иначе как RemoveEdge(from_v, to_v)
+     * @param handle ручка ребра
+     * @throw std::exception Если ребра уже нет в графе
+     */
+    void RemoveEdge(const EdgeHandle& handle);
+    /*!
+     * Ручка существующего ребра
+     * @param from_v одна из вершин ребра
+     * @param to_v другая вершина ребра
+     * @return Ручка ребра для RemoveEdge и SetWeight
+     * @throw std::exception Если ребра нет в графе
+     */
+    EdgeHandle FindEdgeHandle(const VertexId& from_v, const VertexId& to_v) const;
+    /*!
+     * Меняет вес ребра на месте за O(1), если ручка не устарела; ребро не удаляется и не вставляется заново,
+     * поэтому его слот в столбцах свойств и ручки ребра остаются прежними
+     * @param handle ручка ребра
+     * @param weight новый вес
+     * @throw std::exception Если ребра нет в графе
+     * @note Есть только у взвешенного графа
+     */
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    void SetWeight(const EdgeHandle& handle, const W& weight) {
+        EdgeHandle h = this->resolve(handle);
+        this->unindexEdge(h.from, h.to, this->edge[h.from][h.from_pos]);
+        this->edge.Mutable(h.from).SetWeight(h.from_pos, weight);
+        if (h.from != h.to) {
+            this->edge.Mutable(h.to).SetWeight(h.to_pos, weight);
+        }
+        this->indexEdge(h.from, h.to, this->edge[h.from][h.from_pos]);
+    }
+    /*!
+     * Меняет вес ребра между двумя вершинами на месте
+     * @param from_v одна из вершин ребра
+     * @param to_v другая вершина ребра
+     * @param weight новый вес
+     * @throw std::exception Если ребра нет в графе
+     * @note Есть только у взвешенного графа
+     */
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    void SetWeight(const VertexId& from_v, const VertexId& to_v, const W& weight) {
+        this->SetWeight(this->FindEdgeHandle(from_v, to_v), weight);
+    }
+
+
+    // пакетные изменения
+    /*!
+     * Добавляет в граф пачку ребер. Пачка проверяется целиком до изменений: при ошибке граф не меняется
+     * @param edges ребра, которые нужно добавить; их вершины должны уже быть в графе
+     * @throw std::exception Если какой-то вершины нет в графе или какое-то ребро уже есть в графе или повторяется в пачке
+     * @note Полуребра группируются по вершинам, каждый список смежности растет не больше одного раза,
+     * разные вершины заполняются параллельно
+     */
+    void AddEdges(const std::vector<Edge>& edges);
+    /*!
+     * Удаляет из графа пачку ребер. Пачка проверяется целиком до изменений: при ошибке граф не меняется
+     * @param edges ребра, которые нужно удалить, вес не учитывается
+     * @throw std::exception Если какого-то ребра нет в графе или оно повторяется в пачке
+     * @note Каждый затронутый список смежности фильтруется один раз, разные вершины обрабатываются параллельно
+     */
+    void RemoveEdges(const std::vector<Edge>& edges);
+    /*!
+     * Удаляет из графа пачку вершин вместе со всеми их ребрами. Пачка проверяется целиком до изменений
+     * @param vertices номера вершин
+     * @throw std::exception Если какой-то вершины нет в графе или она повторяется в пачке
+     * @note Освободившиеся места заполняются вершинами с конца массива, поэтому переезжает не больше вершин,
+     * чем удаляется, и каждый список смежности перенумеровывается не больше одного раза
+     */
+    void RemoveVertices(const std::vector<VertexId>& vertices);
+
+
+    // индекс весов
+    /*!
+     * Строит индекс ребер по весу за O(E log E). Дальше его поддерживают все изменения ребер и вершин графа, каждое
+     * ребро за O(log E), а запросы EdgesInWeightRange, LightestEdges и FindMST не сортируют ребра
+     * @note Есть только у взвешенного графа. Граф, построенный из списка ребер, извлеченный подграф и минимальное
+     * остовное дерево создаются без индекса. Копия графа разделяет индекс с оригиналом за O(1); копия, которая меняет
+     * ребро, индекс не копирует, а отпускает, и строит свой заново за O(E log E) при первом запросе
+     * EdgesInWeightRange или LightestEdges. Пока индекс не построен заново, FindMST обходится без него
+     */
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    void EnableWeightIndex() {
+        this->buildWeightIndex();
+    }
+    /*!
+     * Удаляет индекс ребер по весу и освобождает его память
+     */
+    void DisableWeightIndex();
+    /*!
+     * @return Включен ли индекс ребер по весу
+     */
+    bool HasWeightIndex() const noexcept;
+    /*!
+     * Функция, показывающая ребра с весом из отрезка [lo, hi] за O(log E + k), где k - количество найденных ребер
+     * @param lo наименьший вес
+     * @param hi наибольший вес
+     * @return Ребра по возрастанию веса, при равных весах - по возрастанию вершин; меньшая вершина ребра идет первой,
+     * петли тоже выдаются
+     * @throw std::exception Если индекс весов не построен
+     * @note Есть только у взвешенного графа
+     */
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    std::vector<Edge> EdgesInWeightRange(const W& lo, const W& hi) const {
+        std::shared_ptr<const detail::WeightIndex<VertexId, W>> index = this->builtWeightIndex();
+        std::vector<Edge> edges;
+        for (auto it = index->lower_bound(detail::WeightKey<VertexId, W>::Lowest(lo)); it != index->end() && !(hi < it->weight); ++it) {
+            edges.emplace_back(it->from, it->to, it->weight);
+        }
+        return edges;
+    }
+    /*!
+     * Функция, показывающая k самых легких ребер за O(log E + k)
+     * @param k сколько ребер нужно; если ребер меньше, выдаются все
+     * @return Ребра в том же порядке, что у EdgesInWeightRange
+     * @throw std::exception Если индекс весов не построен
+     * @note Есть только у взвешенного графа
+     */
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    std::vector<Edge> LightestEdges(size_t k) const {
+        std::shared_ptr<const detail::WeightIndex<VertexId, W>> index = this->builtWeightIndex();
+        std::vector<Edge> edges;
+        edges.reserve(std::min(k, index->size()));
+        for (auto it = index->begin(); it != index->end() && edges.size() < k; ++it) {
+            edges.emplace_back(it->from, it->to, it->weight);
+        }
+        return edges;
+    }
+
+
+    // свойства вершин и ребер
+    /*!
+     * Столбец свойства вершин для чтения; если его нет, он создается со значениями T() у всех вершин
+     * @param name имя свойства
+     * @return Столбец: значение вершины AllVertex()[i] лежит в слоте i (см. VertexSlot)
+     * @throw std::exception Если свойство вершин с таким именем есть, но у него другой тип
+     * @note Столбец растет и сжимается вместе с графом: новая вершина получает значение T(), а при удалении вершины
+     * на ее слот переезжает значение той же вершины, что переезжает на ее место. Граф, построенный из списка
+     * ребер или прочитанный из потока, извлеченный подграф, снимок и остовное дерево создаются без свойств.
+     * Значения меняются через SetVertexProperty или MutableVertexProperty
+     */
+    template <class T>
+    const PropertyColumn<T>& VertexProperty(std::string_view name) {
+        return this->readableProperty<T>(false, name);
+    }
+    /*!
+     * @param name имя свойства
+     * @return Столбец свойства вершин
+     * @throw std::exception Если свойства вершин с таким именем и типом нет
+     */
+    template <class T>
+    const PropertyColumn<T>& VertexProperty(std::string_view name) const {
+        return this->property<T>(false, name);
+    }
+    /*!
+     * Столбец свойства ребер для чтения; если его нет, он создается со значениями T() у всех ребер, включая петли
+     * @param name имя свойства
+     * @return Столбец: значение ребра лежит в слоте EdgeSlot(from_v, to_v)
+     * @throw std::exception Если свойство ребер с таким именем есть, но у него другой тип
+     * @note Первый столбец ребер заводит таблицу слотов ребер за O(E); дальше добавление ребра занимает
+     * последний слот, а удаление переносит последний слот на место удаленного ребра. Значения меняются через
+     * SetEdgeProperty или MutableEdgeProperty
+     */
+    template <class T>
+    const PropertyColumn<T>& EdgeProperty(std::string_view name) {
+        return this->readableProperty<T>(true, name);
+    }
+    /*!
+     * @param name имя свойства
+     * @return Столбец свойства ребер
+     * @throw std::exception Если свойства ребер с таким именем и типом нет
+     */
+    template <class T>
+    const PropertyColumn<T>& EdgeProperty(std::string_view name) const {
+        return this->property<T>(true, name);
+    }
+    /*!
+     * Записывает значение свойства вершины; если столбца нет, он создается. Каждая запись отделяет столбцы этого
+     * графа от копий, поэтому копии и опубликованные версии ее не видят
+     * @param v_num номер вершины
+     * @param name имя свойства
+     * @param value значение; тип свойства T указывается явно, как у VertexProperty
+     * @throw std::exception Если вершины нет в графе или у свойства другой тип
+     */
+    template <class T>
+    void SetVertexProperty(const VertexId& v_num, std::string_view name, const typename detail::NonDeduced<T>::type& value) {
+        size_t slot = this->VertexSlot(v_num);
+        this->property<T>(false, name)[slot] = value;
+    }
+    /*!
+     * Записывает значение свойства ребра; если столбца нет, он создается
+     * @param from_v одна из вершин ребра
+     * @param to_v другая вершина ребра
+     * @param name имя свойства
+     * @param value значение; тип свойства T указывается явно, как у EdgeProperty
+     * @throw std::exception Если ребра нет в графе или у свойства другой тип
+     */
+    template <class T>
+    void SetEdgeProperty(const VertexId& from_v, const VertexId& to_v, std::string_view name, const typename detail::NonDeduced<T>::type& value) {
+        if (!this->HasEdge(from_v, to_v)) {
+            throw Exceptions("Ребра нет в графе\n");
+        }
+        PropertyColumn<T>& column = this->property<T>(true, name);
+        column[this->EdgeSlot(from_v, to_v)] = value;
+    }
+    /*!
+     * Столбец свойства вершин для пакетной записи; если его нет, он создается
+     * @param name имя свойства
+     * @return Столбец, который принадлежит только этому графу в момент вызова
+     * @throw std::exception Если свойство вершин с таким именем есть, но у него другой тип
+     * @warning Ссылка действительна до следующего копирования или изменения графа, в том числе до Commit версионного
+     * графа: копия разделяет столбцы с этим графом, и запись по старой ссылке попала бы и в нее. После копирования
+     * столбец нужно взять заново
+     */
+    template <class T>
+    PropertyColumn<T>& MutableVertexProperty(std::string_view name) {
+        return this->property<T>(false, name);
+    }
+    /*!
+     * Столбец свойства ребер для пакетной записи; если его нет, он создается
+     * @param name имя свойства
+     * @return Столбец, который принадлежит только этому графу в момент вызова
+     * @throw std::exception Если свойство ребер с таким именем есть, но у него другой тип
+     * @warning Ссылка действительна до следующего копирования или изменения графа (см. MutableVertexProperty)
+     */
+    template <class T>
+    PropertyColumn<T>& MutableEdgeProperty(std::string_view name) {
+        return this->property<T>(true, name);
+    }
+    /*!
+     * Удаляет столбец свойства вершин
+     * @param name имя свойства
+     * @return true, если свойство было
+     */
+    bool RemoveVertexProperty(std::string_view name);
+    /*!
+     * Удаляет столбец свойства ребер; вместе с последним столбцом ребер удаляется и таблица слотов ребер
+     * @param name имя свойства
+     * @return true, если свойство было
+     */
+    bool RemoveEdgeProperty(std::string_view name);
+    /*!
+     * @param v_num номер вершины
+     * @return Слот вершины в столбцах свойств вершин за O(1), действительный до следующего изменения множества вершин
+     * @throw std::exception Если вершины нет в графе
+     */
+    size_t VertexSlot(const VertexId& v_num) const;
+    /*!
+     * @param from_v одна из вершин ребра
+     * @param to_v другая вершина ребра
+     * @return Слот ребра в столбцах свойств ребер за O(1), действительный до следующего изменения ребер или вершин
+     * @throw std::exception Если ребра нет в графе или у графа нет свойств ребер
+     */
+    size_t EdgeSlot(const VertexId& from_v, const VertexId& to_v) const;
+    /*!
+     * @param slot слот ребра, меньше размера столбцов свойств ребер
+     * @return Ребро, которому принадлежит слот; меньшая вершина ребра идет первой
+     */
+    Edge SlotEdge(size_t slot) const;
 
 
     /*!
      * Функция поиска минимального остовного дерева в связном, взвешенном графе
-     * @return Объект класса Graph, являющийся минимальным остовным деревом исходного графа
+     * @param resource источник памяти для результата, например GraphArena, если дерево нужно ненадолго
+     * @return Объект класса BasicGraph, являющийся минимальным остовным деревом исходного графа
      * @throw std::exception Если на вход был подан некорректный граф, для которого нельзя построить минимальное остовное дерево
+     * @note У невзвешенного графа любое остовное дерево минимально, поэтому ребра не сортируются. Если построен
+     * индекс весов, ребра берутся из него уже упорядоченными
+     */
+    BasicGraph FindMST(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    /*!
+     * Функция поиска минимального остовного дерева указанным алгоритмом
+     * @param algorithm алгоритм; MstAlgorithm::Auto - то же, что FindMST(resource)
+     * @param resource источник памяти для результата
+     * @return Объект класса BasicGraph, являющийся минимальным остовным деревом исходного графа
+     * @throw std::exception Если граф несвязный
+     * @note Прим обходит списки смежности графа на месте, Краскал без индекса весов, Filter-Kruskal и Борувка работают по снимку Freeze()
+     */
+    BasicGraph FindMST(MstAlgorithm algorithm, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    /*!
+     * Извлекает подграф, порожденный множеством вершин: эти вершины и все ребра между ними
+     * @param vertices номера вершин, повторы допускаются
+     * @param ids оставить номера вершин или перенумеровать их подряд
+     * @param resource источник памяти подграфа
+     * @return Новый граф, не связанный с исходным
+     * @throw std::exception Если какой-то вершины нет в графе
+     * @note Работает за O(V+E) исходного графа: места вершин считаются параллельной префиксной суммой,
+     * и списки смежности заполняются параллельно, каждый резервируется точно под свой размер
+     */
+    BasicGraph InducedSubgraph(const std::vector<VertexId>& vertices, SubgraphIds ids = SubgraphIds::Keep,
+                               std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    /*!
+     * Извлекает все вершины графа и ребра, для которых pred вернул true
+     * @param pred предикат ребра; получает ребро с from_vertex <= other_vertex, вызывается из нескольких потоков
+     * @param ids оставить номера вершин или перенумеровать их подряд
+     * @param resource источник памяти подграфа
+     * @return Новый граф, не связанный с исходным
+     * @note Работает за O(V+E) исходного графа, списки смежности заполняются параллельно
+     */
+    BasicGraph FilterEdges(const std::function<bool(const Edge&)>& pred, SubgraphIds ids = SubgraphIds::Keep,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    /*!
+     * Строит неизменяемый снимок графа в формате CSR за O(V+E)
+     * @return Объект класса BasicFrozenGraph (объявлен в frozen_graph.h), не связанный с дальнейшими изменениями графа
      */
-    Graph FindMST();
+    FrozenGraph Freeze() const;
 
     // функции, описывающие свойства графа
     /*!
      * Функция определения размера графа
      * @return Количество вершин в графе
      */
-    int Size();
+    int Size() const noexcept;
     /*!
      * Функция, показывающая ребра графа
-     * @return Список всех ребер графа
+     * @return Список всех ребер графа без петель, сгруппированных по возрастанию меньшей вершины ребра
      */
-    std::vector<Edge> AllEdges();
+    std::vector<Edge> AllEdges() const;
+    /*!
+     * Функция, показывающая ребра графа без копирования
+     * @param order порядок обхода; для EdgeOrder::ByVertex перестановка вершин считается один раз и кэшируется
+     * @return Ленивый диапазон всех ребер графа, каждое ребро (и петля) встречается один раз,
+     * действительный до следующего изменения графа
+     * @note Граф не меняется, поэтому несколько потоков могут обходить ребра одновременно без блокировок
+     */
+    EdgeRange<VertexId, Weight, Edge> Edges(EdgeOrder order = EdgeOrder::Storage) const;
     /*!
      * Функция, показывающая вершины графа
      * @return Список всех вершин графа
      */
-    std::vector<int> AllVertex();
+    std::vector<VertexId> AllVertex() const;
+    /*!
+     * Функция, показывающая соседей вершины, без копирования списка смежности
+     * @param v_num номер вершины
+     * @return Диапазон соседей (номер вершины и вес ребра) за O(1), действительный до следующего изменения графа
+     * @throw std::exception Если вершины нет в графе
+     * @note Петля дает вершине саму себя в соседях один раз
+     */
+    NeighborRange<VertexId, Weight> Neighbors(const VertexId& v_num) const;
+    /*!
+     * Функция определения степени вершины
+     * @param v_num номер вершины
+     * @return Количество соседей вершины, то есть размер Neighbors(v_num); петля считается один раз
+     * @throw std::exception Если вершины нет в графе
+     */
+    size_t Degree(const VertexId& v_num) const;
+    /*!
+     * Функция проверки вершины за O(1) в среднем по хеш-индексу вершин
+     * @param v_num номер вершины
+     * @return Есть ли вершина в графе
+     */
+    bool HasVertex(const VertexId& v_num) const noexcept;
+    /*!
+     * Функция проверки ребра: O(1) в среднем у хабов и O(log d) галопирующим поиском у остальных вершин
+     * @param from_v одна из вершин ребра
+     * @param to_v другая вершина ребра
+     * @return Есть ли ребро в графе; если какой-то вершины нет, то ребра тоже нет
+     */
+    bool HasEdge(const VertexId& from_v, const VertexId& to_v) const noexcept;
+    /*!
+     * Функция, показывающая вес ребра, с той же сложностью, что HasEdge
+     * @param from_v одна из вершин ребра
+     * @param to_v другая вершина ребра
+     * @return Вес ребра
+     * @throw std::exception Если ребра нет в графе
+     * @note Есть только у взвешенного графа
+     */
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    const W& GetWeight(const VertexId& from_v, const VertexId& to_v) const {
+        int ind_v1 = this->findVertex(from_v);
+        int ind_v2 = this->findVertex(to_v);
+        int pos = (ind_v1 == -1 || ind_v2 == -1) ? -1 : this->findEdge(ind_v1, ind_v2);
+        if (pos == -1) {
+            throw Exceptions("Ребра нет в графе\n");
+        }
+        return this->edge[ind_v1][pos].weight;
+    }
+    /*!
+     * @return Источник памяти графа
+     */
+    std::pmr::memory_resource* Resource() const noexcept;
+
+
+    /*!
+     * Задает порог степени, после которого список смежности вершины перестает быть упорядоченным и получает
+     * хеш-индекс соседей. Списки ниже порога ищутся галопирующим двоичным поиском, выше - хешем за O(1)
+     * @param threshold порог степени
+     */
+    void SetHubThreshold(size_t threshold);
+    /*!
+     * @return Текущий порог степени, после которого список смежности получает хеш-индекс
+     */
+    size_t HubThreshold() const;
+    static constexpr size_t kDefaultHubThreshold = 64;
 
 
     /*!
@@ -161,6 +710,13 @@ public:
     std::istream& ReadFrom(std::istream&);
     std::ostream& WriteTo(std::ostream&) const;
 private:
+    friend class BasicFrozenGraph<VertexId, Weight>;
+    template <class Graph>
+    friend class SubgraphView;
+
+    using Half = HalfEdge<Weight>;
+    using List = AdjacencyList<Weight>;
+
     // класс ошибок
     class Exceptions : public std::exception {
     public:
@@ -172,28 +728,136 @@ private:
         std::string m_error;
     };
 
-    std::vector<int> vertex;
-    std::vector<std::vector<Edge>> edge;
+    detail::CowPtr<std::pmr::vector<VertexId>> vertex;
+    detail::CowChunks<List> edge;
+    detail::CowPtr<HashIndex<VertexId>> vertex_index;
+    size_t hub_threshold = kDefaultHubThreshold;
+    detail::LazyCache<const std::vector<uint32_t>> vertex_order;
+    std::conditional_t<std::is_void_v<Weight>, detail::NoWeightIndex, detail::LazyWeightIndex<VertexId, Weight>> weight_index;
+    bool weight_indexed = false;
+    detail::CowPtr<detail::Properties> properties;
 
-    int findEdge(const int& from_ind, const int& to_num) const;
-    int findVertex(const int& v_num) const;
+    int findEdge(const int& from_ind, const int& to_ind) const noexcept;
+    int findVertex(const VertexId& v_num) const noexcept;
+    // индексы концов ребер: ends[2i], ends[2i + 1] для edges[i], HashIndex::kNotFound для отсутствующих вершин
+    std::vector<uint32_t> findEnds(const std::vector<Edge>& edges) const;
+    // раскладывает ребра по спискам смежности, не проверяя их
+    void appendEdges(const std::vector<uint32_t>& ends, const std::vector<Edge>& edges, size_t threshold);
+    // собирает подграф из вершин с keep[i] != 0 и ребер, прошедших pred; определена в subgraph.cpp
+    template <class Pred>
+    BasicGraph extract(const std::vector<uint32_t>& keep, Pred pred, SubgraphIds ids, std::pmr::memory_resource* resource) const;
+    // минимальная часть работы на поток для операций, выделяющих память в списках смежности: если ресурс графа
+    // нельзя использовать из нескольких потоков, такие операции выполняются в одном потоке
+    size_t listGrain(size_t grain) const;
+    void buildWeightIndex();
+    // граф из ребер остовного дерева графа с n вершинами; бросает исключение, если ребер меньше n - 1
+    static BasicGraph spanningTree(const std::vector<Edge>& tree, size_t n, std::pmr::memory_resource* resource);
+    // ручка с действительными индексами и позициями; бросает исключение, если ребра нет в графе
+    EdgeHandle resolve(const EdgeHandle& handle) const;
+    // удаляет ребро с полуребрами на позициях from_pos в списке from и to_pos в списке to
+    void eraseEdge(uint32_t from, uint32_t to, size_t from_pos, size_t to_pos);
+    // столбец свойства вершин (edge == false) или ребер (edge == true); создается, если его нет
+    template <class T>
+    PropertyColumn<T>& property(bool edge, std::string_view name) {
+        detail::Properties& props = this->properties.Mutable();
+        detail::Column<T>* column = props.template Find<T>(edge, name);
+        if (!column) {
+            if (props.Contains(edge, name)) {
+                throw Exceptions("Свойство уже есть в графе с другим типом\n");
+            }
+            if (edge && !props.HasEdgeColumns()) {
+                this->fillEdgeSlots(props);
+            }
+            column = &props.template Add<T>(edge, name, edge ? props.EdgeCount() : this->vertex->size());
+        }
+        return column->column;
+    }
+    // столбец для чтения: существующий столбец не отделяется от копий графа, отсутствующий создается
+    template <class T>
+    const PropertyColumn<T>& readableProperty(bool edge, std::string_view name) {
+        if (detail::Column<T>* column = this->properties->template Find<T>(edge, name)) {
+            return column->column;
+        }
+        return this->property<T>(edge, name);
+    }
+    template <class T>
+    const PropertyColumn<T>& property(bool edge, std::string_view name) const {
+        detail::Column<T>* column = this->properties->template Find<T>(edge, name);
+        if (!column) {
+            throw Exceptions("Свойства нет в графе\n");
+        }
+        return column->column;
+    }
+    // заводит слоты всем ребрам графа в порядке хранения
+    void fillEdgeSlots(detail::Properties& props) const;
+    // столбцы свойств, которые нужно менять вместе с вершинами или ребрами, или nullptr, если таких нет
+    detail::Properties* vertexProperties();
+    detail::Properties* edgeProperties();
+    // индекс весов для запросов; если он включен, но еще не построен, строится здесь; бросает исключение, если он выключен
+    template <class W = Weight>
+    std::shared_ptr<const detail::WeightIndex<VertexId, W>> builtWeightIndex() const {
+        if (!this->weight_indexed) {
+            throw Exceptions("Индекс весов не построен\n");
+        }
+        return this->weight_index.Build([this](detail::WeightIndex<VertexId, W>& index) {
+            this->fillWeightIndex(index);
+        });
+    }
+    // заполняет пустой индекс весов всеми ребрами графа
+    void fillWeightIndex(detail::WeightIndex<VertexId, Weight>& index) const;
+    // добавляет в индекс весов ребро между внутренними индексами from и to с весом полуребра half или удаляет его оттуда;
+    // без индекса ничего не делают
+    void indexEdge(uint32_t from, uint32_t to, const Half& half);
+    void unindexEdge(uint32_t from, uint32_t to, const Half& half);
+
+    // полуребро к соседу to с весом ребра e
+    static Half makeHalf(uint32_t to, const Edge& e) {
+        if constexpr (std::is_void_v<Weight>) {
+            return {to};
+        } else {
+            return {to, e.weight};
+        }
+    }
+    // ребро между вершинами from_v и to_v с весом полуребра half
+    static Edge makeEdge(const VertexId& from_v, const VertexId& to_v, const Half& half) {
+        if constexpr (std::is_void_v<Weight>) {
+            return Edge(from_v, to_v);
+        } else {
+            return Edge(from_v, to_v, half.weight);
+        }
+    }
 };
 
 /*!
     * Ввод графа через поток
     * @param in поток на чтение
-    * @param graph объект класса Graph
+    * @param graph объект класса BasicGraph
     * @return поток на чтение
     * @note Формат ввода: "vertex:\n<кол-во вершин>\n<вершины через пробел>\n<NotWeight/Weight>\nedge:\n<кол-во ребер>\n<ребра: первая вторая вес(в зависимости от параметра NotWeight/Weight>"
 */
-std::istream& operator>>(std::istream& in, Graph& graph);
+template <class VertexId, class Weight>
+std::istream& operator>>(std::istream& in, BasicGraph<VertexId, Weight>& graph) {
+    return graph.ReadFrom(in);
+}
 /*!
     * Вывод графа через поток
     * @param in поток на запись
-    * @param graph объект класса Graph
+    * @param graph объект класса BasicGraph
     * @return поток на запись
-    * @note Формат ввода: "vertex:\n<кол-во вершин>\n<вершины через пробел>\nedge:\n<ребра: первая вторая вес(в зависимости от параметра NotWeight/Weight>"
+    * @note Формат вывода совпадает с форматом ввода, поэтому записанный граф читается обратно оператором >>;
+    * невзвешенный граф пишется с параметром NotWeight и ребрами без весов
 */
-std::ostream& operator<<(std::ostream& out, Graph& graph);
+template <class VertexId, class Weight>
+std::ostream& operator<<(std::ostream& out, const BasicGraph<VertexId, Weight>& graph) {
+    return graph.WriteTo(out);
+}
+
+using Edge = BasicEdge<int, int>;
+using Graph = BasicGraph<int, int>;
+
+// перечисляет пары (VertexId, Weight), для которых BasicGraph и BasicFrozenGraph собраны в библиотеке
+#define GRAPH_FOR_EACH_INSTANCE(X) \
+    X(int, int) X(int, int64_t) X(int, float) X(int, double) X(int, void) \
+    X(int64_t, int) X(int64_t, int64_t) X(int64_t, float) X(int64_t, double) X(int64_t, void)
 
 #endif
@@ -0,0 +1,343 @@
+#include <graph/graph.h>
+#include <graph/arena.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+
+// Генерирует граф без кратных ребер: вершина u соединена с u + 1, ..., u + degree,
+// номера вершин перемешаны, веса случайные
+std::vector<Edge> GenerateEdges(size_t edge_cnt, size_t degree, std::mt19937& rnd) {
+    size_t vertex_cnt = edge_cnt / degree + degree + 1;
+    std::vector<int> ids(vertex_cnt);
+    for (size_t i = 0; i < vertex_cnt; i++) {
+        ids[i] = i;
+    }
+    std::shuffle(ids.begin(), ids.end(), rnd);
+
+    std::vector<Edge> edges;
+    edges.reserve(edge_cnt);
+    for (size_t u = 0; edges.size() < edge_cnt; u++) {
+        for (size_t d = 1; d <= degree && edges.size() < edge_cnt; d++) {
+            edges.emplace_back(ids[u], ids[u + d], rnd() % 1000 + 1);
+        }
+    }
+    return edges;
+}
+
+template <class F>
+double Measure(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(finish - start).count();
+}
+
+void BenchConstruction(size_t max_edges, bool shuffled) {
+    std::cout << "construction: Graph(const std::vector<Edge>&), " << (shuffled ? "shuffled" : "grouped by vertex") << " edges\n";
+    std::mt19937 rnd(42);
+    for (size_t edge_cnt = 10000; edge_cnt <= max_edges; edge_cnt *= 10) {
+        std::vector<Edge> edges = GenerateEdges(edge_cnt, 4, rnd);
+        if (shuffled) {
+            std::shuffle(edges.begin(), edges.end(), rnd);
+        }
+        double seconds = Measure([&] {
+            Graph gr(edges);
+            if (gr.Size() == 0) {
+                std::abort();
+            }
+        });
+        std::cout << "  edges=" << edge_cnt << "\t" << seconds << " s\n";
+    }
+}
+
+void BenchIncremental(size_t max_edges) {
+    std::cout << "incremental: AddVertex + AddEdge, degree 2 (mostly small vertices)\n";
+    std::mt19937 rnd(42);
+    for (size_t edge_cnt = 10000; edge_cnt <= max_edges; edge_cnt *= 10) {
+        std::vector<Edge> edges = GenerateEdges(edge_cnt, 2, rnd);
+        double seconds = Measure([&] {
+            Graph gr;
+            for (size_t v = 0; v < edge_cnt / 2 + 3; v++) {
+                gr.AddVertex(v);
+            }
+            for (auto& e : edges) {
+                gr.AddEdge(e);
+            }
+        });
+        std::cout << "  edges=" << edge_cnt << "\t" << seconds << " s\n";
+    }
+}
+
+// Копия общего графа на каждый запрос и несколько правок в ней
+void BenchCopies(size_t max_edges) {
+    std::cout << "copies: copy of a shared graph + 4 edge reweights, per copy\n";
+    std::mt19937 rnd(42);
+    const size_t copies = 100;
+    for (size_t edge_cnt = 10000; edge_cnt <= max_edges; edge_cnt *= 10) {
+        std::vector<Edge> edges = GenerateEdges(edge_cnt, 4, rnd);
+        Graph base(edges);
+        double seconds = Measure([&] {
+            for (size_t i = 0; i < copies; i++) {
+                Graph copy = base;
+                for (int k = 0; k < 4; k++) {
+                    const Edge& e = edges[rnd() % edges.size()];
+                    copy.RemoveEdge(e.from_vertex, e.other_vertex);
+                    copy.AddEdge(e.from_vertex, e.other_vertex, e.weight + 1);
+                }
+            }
+        });
+        std::cout << "  edges=" << edge_cnt << "\t" << seconds / copies * 1e6 << " us\n";
+    }
+}
+
+// Извлечение подграфа на половине вершин: пакетно и по одному ребру через AddEdge
+void BenchExtraction(size_t max_edges) {
+    std::cout << "extraction: subgraph induced by half of the vertices\n";
+    std::mt19937 rnd(42);
+    for (size_t edge_cnt = 10000; edge_cnt <= max_edges; edge_cnt *= 10) {
+        std::vector<Edge> edges = GenerateEdges(edge_cnt, 4, rnd);
+        Graph base(edges);
+        std::vector<int> half;
+        for (int v : base.AllVertex()) {
+            if (v % 2 == 0) {
+                half.push_back(v);
+            }
+        }
+        double batch = Measure([&] {
+            Graph sub = base.InducedSubgraph(half);
+        });
+        double one_by_one = Measure([&] {
+            Graph sub;
+            for (int v : half) {
+                sub.AddVertex(v);
+            }
+            for (auto& e : base.AllEdges()) {
+                if (e.from_vertex % 2 == 0 && e.other_vertex % 2 == 0) {
+                    sub.AddEdge(e);
+                }
+            }
+        });
+        std::cout << "  edges=" << edge_cnt << "\tInducedSubgraph " << batch << " s\tAddEdge " << one_by_one << " s\n";
+    }
+}
+
+// Сравнивает изменение веса и удаление ребер по ручкам с тем же через номера вершин
+void BenchHandles(size_t max_edges) {
+    std::cout << "edge handles: reweight and then remove every edge\n";
+    std::mt19937 rnd(42);
+    for (size_t edge_cnt = 10000; edge_cnt <= max_edges; edge_cnt *= 10) {
+        std::vector<Edge> edges = GenerateEdges(edge_cnt, 4, rnd);
+        Graph by_handle(edges);
+        Graph by_vertex(edges);
+        std::vector<Graph::EdgeHandle> handles;
+        handles.reserve(edges.size());
+        for (auto& e : edges) {
+            handles.push_back(by_handle.FindEdgeHandle(e.from_vertex, e.other_vertex));
+        }
+        double reweight_handle = Measure([&] {
+            for (size_t i = 0; i < handles.size(); i++) {
+                by_handle.SetWeight(handles[i], edges[i].weight + 1);
+            }
+        });
+        double reweight_vertex = Measure([&] {
+            for (auto& e : edges) {
+                by_vertex.RemoveEdge(e.from_vertex, e.other_vertex);
+                by_vertex.AddEdge(e.from_vertex, e.other_vertex, e.weight + 1);
+            }
+        });
+        double remove_handle = Measure([&] {
+            for (auto& handle : handles) {
+                by_handle.RemoveEdge(handle);
+            }
+        });
+        double remove_vertex = Measure([&] {
+            for (auto& e : edges) {
+                by_vertex.RemoveEdge(e.from_vertex, e.other_vertex);
+            }
+        });
+        std::cout << "  edges=" << edge_cnt << "\tSetWeight " << reweight_handle << " s\tRemoveEdge+AddEdge " << reweight_vertex
+                  << " s\tRemoveEdge(handle) " << remove_handle << " s\tRemoveEdge(u, v) " << remove_vertex << " s\n";
+    }
+}
+
+// Сравнивает обход свойства вершин в столбце графа с обходом той же таблицы std::map по номерам вершин
+void BenchProperties(size_t max_edges) {
+    std::cout << "properties: sum of a vertex property over all vertices\n";
+    std::mt19937 rnd(42);
+    for (size_t edge_cnt = 10000; edge_cnt <= max_edges; edge_cnt *= 10) {
+        Graph gr(GenerateEdges(edge_cnt, 4, rnd));
+        std::map<int, int64_t> side_table;
+        PropertyColumn<int64_t>& column = gr.MutableVertexProperty<int64_t>("timestamp");
+        for (int v : gr.AllVertex()) {
+            side_table[v] = v;
+            column[gr.VertexSlot(v)] = v;
+        }
+        int64_t map_sum = 0;
+        int64_t column_sum = 0;
+        double by_map = Measure([&] {
+            for (int v : gr.AllVertex()) {
+                map_sum += side_table.at(v);
+            }
+        });
+        double by_column = Measure([&] {
+            for (int64_t value : column) {
+                column_sum += value;
+            }
+        });
+        std::cout << "  edges=" << edge_cnt << "\tstd::map " << by_map << " s\tcolumn " << by_column << " s"
+                  << (map_sum == column_sum ? "" : "\tMISMATCH") << '\n';
+    }
+}
+
+// Сравнивает запросы к индексу весов с сортировкой всех ребер и минимальное остовное дерево с индексом и без него
+void BenchWeightIndex(size_t max_edges) {
+    std::cout << "weight index: 100 lightest edges, FindMST\n";
+    std::mt19937 rnd(42);
+    for (size_t edge_cnt = 10000; edge_cnt <= max_edges; edge_cnt *= 10) {
+        std::vector<Edge> edges = GenerateEdges(edge_cnt, 4, rnd);
+        Graph gr(edges);
+        double sorted = Measure([&] {
+            std::vector<Edge> all = gr.AllEdges();
+            std::partial_sort(all.begin(), all.begin() + 100, all.end(), [](const Edge& a, const Edge& b) {
+                return a.weight < b.weight;
+            });
+        });
+        double mst = Measure([&] {
+            gr.FindMST();
+        });
+        double build = Measure([&] {
+            gr.EnableWeightIndex();
+        });
+        double lightest = Measure([&] {
+            gr.LightestEdges(100);
+        });
+        double indexed_mst = Measure([&] {
+            gr.FindMST();
+        });
+        std::cout << "  edges=" << edge_cnt << "\tAllEdges+sort " << sorted << " s\tLightestEdges " << lightest
+                  << " s\tFindMST " << mst << " s\tindexed FindMST " << indexed_mst << " s\tbuild index " << build << " s\n";
+    }
+}
+
+// Сравнивает алгоритмы Краскала и Прима на разреженных и плотных графах с одинаковым количеством ребер
+void BenchMst(size_t max_edges) {
+    std::cout << "FindMST: Kruskal vs Filter-Kruskal vs Prim vs Boruvka, " << max_edges << " edges\n";
+    std::mt19937 rnd(42);
+    for (size_t degree = 2; degree <= 512; degree *= 4) {
+        Graph gr(GenerateEdges(max_edges, degree, rnd));
+        Graph kruskal_tree;
+        Graph prim_tree;
+        double kruskal = Measure([&] {
+            kruskal_tree = gr.FindMST(MstAlgorithm::Kruskal);
+        });
+        double prim = Measure([&] {
+            prim_tree = gr.FindMST(MstAlgorithm::Prim);
+        });
+        auto total = [](const Graph& tree) {
+            long long sum = 0;
+            for (auto& e : tree.AllEdges()) {
+                sum += e.weight;
+            }
+            return sum;
+        };
+        Graph filter_tree;
+        double filter = Measure([&] {
+            filter_tree = gr.FindMST(MstAlgorithm::FilterKruskal);
+        });
+        Graph boruvka_tree;
+        double boruvka = Measure([&] {
+            boruvka_tree = gr.FindMST(MstAlgorithm::Boruvka);
+        });
+        double automatic = Measure([&] {
+            gr.FindMST(MstAlgorithm::Auto);
+        });
+        long long expected = total(kruskal_tree);
+        bool same = total(prim_tree) == expected && total(filter_tree) == expected && total(boruvka_tree) == expected;
+        std::cout << "  vertices=" << gr.Size() << "\tdegree=" << 2 * degree << "\tKruskal " << kruskal << " s\tFilter-Kruskal "
+                  << filter << " s\tPrim " << prim << " s\tBoruvka " << boruvka << " s\tAuto " << automatic << " s"
+                  << (same ? "" : "\tMISMATCH") << '\n';
+    }
+}
+
+// Считает выделения, дошедшие до него, и передает их дальше в new/delete
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+private:
+    void* do_allocate(size_t size, size_t alignment) override {
+        allocations++;
+        bytes += size;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void* p, size_t size, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Строит граф вершинами и ребрами по одному и разрушает его, считая выделения памяти у системного аллокатора
+template <class MakeResource>
+void BenchAllocationsWith(const char* name, const std::vector<Edge>& edges, size_t vertex_cnt, MakeResource make_resource) {
+    CountingResource counting;
+    double build = 0;
+    double destroy = 0;
+    {
+        auto resource = make_resource(&counting);
+        std::unique_ptr<Graph> gr;
+        build = Measure([&] {
+            gr = std::make_unique<Graph>(resource ? resource.get() : static_cast<std::pmr::memory_resource*>(&counting));
+            for (size_t v = 0; v < vertex_cnt; v++) {
+                gr->AddVertex(v);
+            }
+            for (auto& e : edges) {
+                gr->AddEdge(e);
+            }
+        });
+        destroy = Measure([&] {
+            gr.reset();
+            resource.reset();
+        });
+    }
+    std::cout << "  " << name << "\tallocations=" << counting.allocations << "\tbytes=" << counting.bytes
+              << "\tbuild " << build << " s\tdestroy " << destroy << " s\n";
+}
+
+void BenchAllocations(size_t max_edges) {
+    size_t edge_cnt = std::min<size_t>(max_edges, 1000000);
+    std::cout << "allocations: AddVertex + AddEdge, degree 4, edges=" << edge_cnt << "\n";
+    std::mt19937 rnd(42);
+    std::vector<Edge> edges = GenerateEdges(edge_cnt, 4, rnd);
+    size_t vertex_cnt = edge_cnt / 4 + 5;
+    BenchAllocationsWith("new/delete", edges, vertex_cnt, [](std::pmr::memory_resource*) {
+        return std::unique_ptr<std::pmr::memory_resource>();
+    });
+    BenchAllocationsWith("AdjacencyPool", edges, vertex_cnt, [](std::pmr::memory_resource* upstream) {
+        return std::unique_ptr<std::pmr::memory_resource>(new AdjacencyPool(upstream));
+    });
+    BenchAllocationsWith("GraphArena", edges, vertex_cnt, [](std::pmr::memory_resource* upstream) {
+        return std::unique_ptr<std::pmr::memory_resource>(new GraphArena(GraphArena::kDefaultBlockSize, upstream));
+    });
+}
+
+// Использование: graph_bench [максимальное количество ребер, по умолчанию 10^7]
+int main(int argc, char** argv) {
+    size_t max_edges = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    BenchConstruction(max_edges, false);
+    BenchConstruction(max_edges, true);
+    BenchIncremental(max_edges);
+    BenchCopies(max_edges);
+    BenchExtraction(max_edges);
+    BenchWeightIndex(max_edges);
+    BenchMst(max_edges);
+    BenchProperties(max_edges);
+    BenchHandles(max_edges);
+    BenchAllocations(max_edges);
+    return 0;
+}
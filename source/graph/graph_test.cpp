@@ -1,6 +1,18 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include <graph/graph.h>
+#include <graph/frozen_graph.h>
+#include <graph/small_vector.h>
+#include <graph/arena.h>
+#include <graph/versioned_graph.h>
+#include <graph/subgraph_view.h>
+#include <graph/disjoint_set.h>
+
+#include <map>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <utility>
 
 
 TEST_CASE("init_simple") {
@@ -241,3 +253,1395 @@ TEST_CASE("MST") {
         CHECK(gr_edges_mst[i].weight == edges_MST[i].weight);
     }
 }
+
+
+TEST_CASE("vertex_index_after_remove") {
+    Graph gr;
+    for (int i = 0; i < 1000; i++) {
+        gr.AddVertex(i * 7919);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        gr.RemoveVertex(i * 7919);
+    }
+    CHECK(gr.Size() == 500);
+
+    // вершины, переехавшие при удалении, должны находиться по своему номеру
+    for (int i = 1; i < 1000; i += 2) {
+        CHECK_NOTHROW(gr.AddEdge(i * 7919, (i + 2) % 1000 * 7919));
+        CHECK_THROWS(gr.AddVertex(i * 7919));
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        CHECK_THROWS(gr.RemoveVertex(i * 7919));
+    }
+    CHECK(gr.AllEdges().size() == 500);
+}
+
+TEST_CASE("freeze") {
+    std::vector<Edge> edges = {Edge(5, 2, 3),
+                               Edge(5, 9, 1),
+                               Edge(2, 9, 2),
+                               Edge(9, 4, 6)};
+    Graph gr(edges);
+    FrozenGraph frozen = gr.Freeze();
+    gr.RemoveVertex(9);
+
+    CHECK(frozen.Size() == 4);
+    std::vector<int> fr_vertex = frozen.AllVertex();
+    std::sort(fr_vertex.begin(), fr_vertex.end());
+    CHECK(fr_vertex == std::vector<int>({2, 4, 5, 9}));
+    CHECK(frozen.AllEdges().size() == edges.size());
+
+    Graph mstGraph = frozen.FindMST();
+    CHECK(mstGraph.Size() == 4);
+    std::vector<Edge> gr_edges_mst = mstGraph.AllEdges();
+    CHECK(gr_edges_mst.size() == 3);
+    int total = 0;
+    for (auto& e : gr_edges_mst) {
+        total += e.weight;
+    }
+    CHECK(total == 9);
+}
+
+TEST_CASE("remove_vertex_adjacent_to_last") {
+    std::vector<Edge> edges = {Edge(1, 2, 4), Edge(1, 3, 5), Edge(2, 3, 6)};
+    Graph gr(edges);
+    gr.RemoveVertex(1);
+
+    CHECK(gr.Size() == 2);
+    std::vector<Edge> gr_edges = gr.AllEdges();
+    CHECK(gr_edges.size() == 1);
+    CHECK(gr_edges[0].from_vertex == 2);
+    CHECK(gr_edges[0].other_vertex == 3);
+    CHECK(gr_edges[0].weight == 6);
+    CHECK_NOTHROW(gr.AddVertex(1));
+    CHECK_NOTHROW(gr.AddEdge(3, 1, 7));
+}
+
+// сравнивает граф с моделью: номер вершины -> (сосед -> вес)
+void CheckSameGraph(Graph& gr, std::map<int, std::map<int, int>>& model) {
+    CHECK(gr.Size() == model.size());
+    std::vector<int> gr_vertex = gr.AllVertex();
+    std::sort(gr_vertex.begin(), gr_vertex.end());
+    std::vector<int> expected_vertex;
+    std::vector<std::tuple<int, int, int>> expected;
+    for (auto& v : model) {
+        expected_vertex.push_back(v.first);
+        for (auto& other : v.second) {
+            if (v.first < other.first) {
+                expected.emplace_back(v.first, other.first, other.second);
+            }
+        }
+    }
+    CHECK(gr_vertex == expected_vertex);
+
+    std::vector<std::tuple<int, int, int>> actual;
+    for (auto& e : gr.AllEdges()) {
+        actual.emplace_back(e.from_vertex, e.other_vertex, e.weight);
+    }
+    std::sort(actual.begin(), actual.end());
+    CHECK(actual == expected);
+}
+
+TEST_CASE("random_operations") {
+    // сверяем граф с простой моделью на std::map после серии случайных изменений,
+    // в том числе с маленьким порогом, при котором почти все списки смежности становятся хабами
+    for (size_t threshold : {Graph::kDefaultHubThreshold, size_t(4), size_t(1)}) {
+        Graph gr;
+        gr.SetHubThreshold(threshold);
+        std::map<int, std::map<int, int>> model;
+        for (int step = 0; step < 3000; step++) {
+            int op = rand() % 4;
+            int v1 = rand() % 60;
+            int v2 = rand() % 60;
+            if (op == 0) {
+                if (model.count(v1)) {
+                    CHECK_THROWS(gr.AddVertex(v1));
+                } else {
+                    gr.AddVertex(v1);
+                    model[v1];
+                }
+            } else if (op == 1) {
+                if (!model.count(v1)) {
+                    CHECK_THROWS(gr.RemoveVertex(v1));
+                } else {
+                    gr.RemoveVertex(v1);
+                    for (auto& other : model[v1]) {
+                        if (other.first != v1) {
+                            model[other.first].erase(v1);
+                        }
+                    }
+                    model.erase(v1);
+                }
+            } else if (op == 2) {
+                if (!model.count(v1) || !model.count(v2)) {
+                    continue;
+                }
+                int weight = rand() % 10 + 1;
+                if (model[v1].count(v2)) {
+                    CHECK_THROWS(gr.AddEdge(v1, v2, weight));
+                } else {
+                    gr.AddEdge(v1, v2, weight);
+                    model[v1][v2] = weight;
+                    model[v2][v1] = weight;
+                }
+            } else {
+                if (!model.count(v1) || !model[v1].count(v2)) {
+                    CHECK_THROWS(gr.RemoveEdge(v1, v2));
+                } else {
+                    gr.RemoveEdge(v1, v2);
+                    model[v1].erase(v2);
+                    model[v2].erase(v1);
+                }
+            }
+        }
+
+        CheckSameGraph(gr, model);
+    }
+}
+
+TEST_CASE("init_duplicates") {
+    std::vector<Edge> edges = {Edge(4, -2, 3), Edge(7, 4, 1), Edge(-2, 4, 8), Edge(7, 7, 2), Edge(7, 7, 5)};
+    CHECK_THROWS(Graph(edges));
+    CHECK_THROWS(Graph(edges, DuplicateEdges::Reject));
+
+    Graph gr(edges, DuplicateEdges::Drop);
+    CHECK(gr.Size() == 3);
+    std::vector<int> gr_vertex = gr.AllVertex();
+    CHECK(gr_vertex == std::vector<int>({-2, 4, 7}));
+
+    // остается первое вхождение ребра
+    std::vector<Edge> gr_edges = gr.AllEdges();
+    CHECK(gr_edges.size() == 2);
+    CHECK(gr_edges[0].from_vertex == -2);
+    CHECK(gr_edges[0].other_vertex == 4);
+    CHECK(gr_edges[0].weight == 3);
+    CHECK(gr_edges[1].from_vertex == 4);
+    CHECK(gr_edges[1].other_vertex == 7);
+    CHECK(gr_edges[1].weight == 1);
+
+    CHECK_NOTHROW(gr.RemoveEdge(7, 7));
+    CHECK_THROWS(gr.RemoveEdge(7, 7));
+    CHECK_NOTHROW(gr.RemoveVertex(4));
+    CHECK(gr.AllEdges().empty());
+}
+
+TEST_CASE("batch_operations") {
+    Graph gr;
+    std::map<int, std::map<int, int>> model;
+    for (int v = 0; v < 200; v++) {
+        gr.AddVertex(v * 3);
+        model[v * 3];
+    }
+
+    for (int round = 0; round < 30; round++) {
+        // пачка новых ребер без повторов
+        std::vector<Edge> add;
+        std::map<std::pair<int, int>, int> in_batch;
+        for (int k = 0; k < 100; k++) {
+            auto it1 = std::next(model.begin(), rand() % model.size());
+            auto it2 = std::next(model.begin(), rand() % model.size());
+            int v1 = it1->first;
+            int v2 = it2->first;
+            if (v1 == v2 || model[v1].count(v2) || in_batch.count({std::min(v1, v2), std::max(v1, v2)})) {
+                continue;
+            }
+            int weight = rand() % 50 + 1;
+            in_batch[{std::min(v1, v2), std::max(v1, v2)}] = weight;
+            add.emplace_back(v1, v2, weight);
+        }
+        gr.AddEdges(add);
+        for (auto& e : add) {
+            model[e.from_vertex][e.other_vertex] = e.weight;
+            model[e.other_vertex][e.from_vertex] = e.weight;
+        }
+
+        // пачка с повтором или с уже существующим ребром отклоняется целиком
+        if (!add.empty()) {
+            std::vector<Edge> bad = {add.back()};
+            CHECK_THROWS(gr.AddEdges(bad));
+        }
+
+        // удаляем часть ребер
+        std::vector<Edge> remove;
+        for (auto& e : add) {
+            if (rand() % 3 == 0) {
+                remove.emplace_back(e.other_vertex, e.from_vertex);
+            }
+        }
+        gr.RemoveEdges(remove);
+        for (auto& e : remove) {
+            model[e.from_vertex].erase(e.other_vertex);
+            model[e.other_vertex].erase(e.from_vertex);
+        }
+        if (!remove.empty()) {
+            CHECK_THROWS(gr.RemoveEdges(remove));
+        }
+
+        // удаляем несколько вершин и добавляем новые
+        std::vector<int> remove_v;
+        for (auto& v : model) {
+            if (rand() % 20 == 0) {
+                remove_v.push_back(v.first);
+            }
+        }
+        gr.RemoveVertices(remove_v);
+        for (int v : remove_v) {
+            for (auto& other : model[v]) {
+                model[other.first].erase(v);
+            }
+            model.erase(v);
+        }
+        for (int k = 0; k < 10; k++) {
+            int v = 1000 + round * 10 + k;
+            gr.AddVertex(v);
+            model[v];
+        }
+        CheckSameGraph(gr, model);
+    }
+    CHECK_THROWS(gr.RemoveVertices({1000, 1000}));
+    CHECK_THROWS(gr.RemoveVertices({-5}));
+    CheckSameGraph(gr, model);
+}
+
+TEST_CASE("small_vector") {
+    detail::SmallVector<int, 4> vec;
+    CHECK(vec.IsInline());
+    for (int i = 0; i < 4; i++) {
+        vec.push_back(i);
+    }
+    CHECK(vec.IsInline());
+    vec.insert(vec.begin() + 1, 10);
+    CHECK(!vec.IsInline());
+    CHECK(std::vector<int>(vec.begin(), vec.end()) == std::vector<int>({0, 10, 1, 2, 3}));
+
+    detail::SmallVector<int, 4> copy = vec;
+    detail::SmallVector<int, 4> moved = std::move(vec);
+    CHECK(vec.empty());
+    CHECK(std::vector<int>(moved.begin(), moved.end()) == std::vector<int>({0, 10, 1, 2, 3}));
+
+    copy.erase(copy.begin(), copy.begin() + 2);
+    copy.ShrinkToFit();
+    CHECK(copy.IsInline());
+    CHECK(std::vector<int>(copy.begin(), copy.end()) == std::vector<int>({1, 2, 3}));
+    moved = copy;
+    CHECK(std::vector<int>(moved.begin(), moved.end()) == std::vector<int>({1, 2, 3}));
+}
+
+// считает живые блоки, выделенные через него
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t live = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations++;
+        live++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        live--;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST_CASE("memory_resource") {
+    CountingResource counting;
+    {
+        std::vector<Edge> edges;
+        for (int v = 0; v < 300; v++) {
+            edges.emplace_back(v, (v * 7 + 1) % 300, v + 1);
+            edges.emplace_back(0, v + 1, v + 2);
+        }
+        Graph gr(edges, DuplicateEdges::Drop, &counting);
+        CHECK(gr.Resource() == &counting);
+        size_t after_build = counting.allocations;
+        CHECK(after_build > 0);
+
+        gr.AddVertex(1000);
+        gr.AddEdge(1000, 0, 5);
+        gr.RemoveVertex(5);
+        gr.RemoveEdges({Edge(0, 1)});
+        CHECK(counting.allocations > after_build);
+
+        // копия, как у std::pmr контейнеров, берет ресурс по умолчанию, а присваивание сохраняет свой ресурс
+        Graph copy = gr;
+        CHECK(copy.Resource() == std::pmr::get_default_resource());
+        Graph assigned(&counting);
+        assigned = copy;
+        CHECK(assigned.Resource() == &counting);
+        CHECK(assigned.AllEdges().size() == gr.AllEdges().size());
+        assigned = std::move(copy);
+        CHECK(assigned.Resource() == &counting);
+        CHECK(assigned.AllEdges().size() == gr.AllEdges().size());
+
+        // при равных ресурсах перемещающее присваивание забирает данные и ничего не выделяет
+        Graph source(&counting);
+        source = gr;
+        Graph target(&counting);
+        target = gr;
+        size_t before_move = counting.allocations;
+        target = std::move(source);
+        CHECK(counting.allocations == before_move);
+        CHECK(target.AllEdges().size() == gr.AllEdges().size());
+
+        GraphArena arena;
+        Graph mst = gr.FindMST(&arena);
+        CHECK(mst.Resource() == &arena);
+        CHECK(mst.Size() == gr.Size());
+
+        AdjacencyPool pool;
+        Graph pooled(edges, DuplicateEdges::Drop, &pool);
+        CHECK(pooled.FindMST().AllEdges().size() == mst.AllEdges().size());
+    }
+    CHECK(counting.live == 0);
+    CHECK(sizeof(AdjacencyList<int>) == 64);
+}
+
+TEST_CASE("typed_graphs") {
+    // 64-битные номера вершин и вещественные веса
+    using WideGraph = BasicGraph<int64_t, double>;
+    int64_t big = int64_t(1) << 40;
+    std::vector<WideGraph::Edge> wide_edges = {{big, -big, 0.5}, {-big, 3, 0.25}, {3, big, 2.5}, {big + 1, 3, 1.0}};
+    WideGraph wide(wide_edges);
+    CHECK(wide.Size() == 4);
+    CHECK(wide.AllVertex() == std::vector<int64_t>({-big, 3, big, big + 1}));
+    wide.AddEdge(big + 1, -big, 0.125);
+    WideGraph wide_mst = wide.FindMST();
+    double total = 0;
+    for (auto& e : wide_mst.AllEdges()) {
+        total += e.weight;
+    }
+    CHECK(total == doctest::Approx(0.875));
+
+    // невзвешенный граф не хранит весов
+    using PlainGraph = BasicGraph<int, void>;
+    CHECK(sizeof(HalfEdge<void>) == 4);
+    CHECK(AdjacencyList<void>::kInlineHalfEdges > AdjacencyList<int>::kInlineHalfEdges);
+    BasicGraph<int, void> plain({{1, 2}, {2, 3}, {3, 1}, {3, 4}});
+    plain.AddVertex(5);
+    plain.AddEdge(5, 1);
+    CHECK_THROWS(plain.AddEdge(1, 5));
+    PlainGraph plain_mst = plain.FindMST();
+    CHECK(plain_mst.Size() == 5);
+    CHECK(plain_mst.AllEdges().size() == 4);
+    CHECK_THROWS(PlainGraph({{1, 2}, {3, 4}}).FindMST());
+    CHECK_THROWS(Graph({{1, 2, 1}, {3, 4, 1}}).FindMST());
+}
+
+TEST_CASE("read_write") {
+    Graph gr;
+    for (int v : {1, 2, 3, 4}) {
+        gr.AddVertex(v);
+    }
+    gr.AddEdge(1, 2, 5);
+    gr.AddEdge(2, 3, 7);
+    gr.AddEdge(4, 4, 2);
+    std::stringstream text;
+    text << gr;
+    Graph read;
+    text >> read;
+    CHECK(!text.fail());
+    CHECK(read.AllVertex() == gr.AllVertex());
+    CHECK(read.AllEdges().size() == 2);
+    CHECK_NOTHROW(read.RemoveEdge(4, 4));
+
+    // чтение сохраняет порог хабов графа
+    Graph hubs;
+    hubs.SetHubThreshold(2);
+    std::stringstream star;
+    star << Graph({{1, 2, 1}, {1, 3, 1}, {1, 4, 1}});
+    star >> hubs;
+    CHECK(!star.fail());
+    CHECK(hubs.HubThreshold() == 2);
+    CHECK(hubs.Degree(1) == 3);
+    std::stringstream round_trip;
+    round_trip << hubs;
+    round_trip >> hubs;
+    CHECK(hubs.HubThreshold() == 2);
+    CHECK(hubs.AllEdges().size() == 3);
+
+    // невзвешенный граф читает взвешенный формат, отбрасывая веса
+    BasicGraph<int, void> plain;
+    std::stringstream again;
+    again << gr;
+    again >> plain;
+    CHECK(!again.fail());
+    CHECK(plain.AllEdges().size() == 2);
+    std::stringstream plain_text;
+    plain_text << plain;
+    CHECK(plain_text.str().find("NotWeight") != std::string::npos);
+    Graph weighted;
+    plain_text >> weighted;
+    CHECK(weighted.AllEdges()[0].weight == 1);
+
+    std::stringstream broken("vertex:\n2\n1 2\nWeight\nedge:\n1\n1 2 0\n");
+    broken >> weighted;
+    CHECK(broken.fail());
+}
+
+TEST_CASE("neighbors") {
+    Graph gr({{1, 2, 5}, {1, 3, 7}, {1, 1, 2}, {4, 3, 1}});
+    CHECK(gr.Degree(1) == 3);
+    CHECK(gr.Degree(4) == 1);
+    CHECK_THROWS(gr.Degree(10));
+    CHECK_THROWS(gr.Neighbors(10));
+
+    std::vector<std::pair<int, int>> around;
+    for (auto neighbor : gr.Neighbors(1)) {
+        around.emplace_back(neighbor.vertex, neighbor.weight);
+    }
+    std::sort(around.begin(), around.end());
+    CHECK(around == std::vector<std::pair<int, int>>({{1, 2}, {2, 5}, {3, 7}}));
+
+    auto range = gr.Neighbors(3);
+    CHECK(range.size() == 2);
+    CHECK(std::count_if(range.begin(), range.end(), [](const Graph::Neighbor& n) {
+        return n.weight > 3;
+    }) == 1);
+    auto lightest = std::min_element(range.begin(), range.end(), [](const Graph::Neighbor& a, const Graph::Neighbor& b) {
+        return a.weight < b.weight;
+    });
+    CHECK((*lightest).vertex == 4);
+    CHECK(range.end() - range.begin() == 2);
+
+    // номера соседей переводятся и у хабов, и после перенумерации вершин
+    gr.SetHubThreshold(1);
+    gr.RemoveVertex(2);
+    std::vector<int> ids;
+    for (auto neighbor : gr.Neighbors(1)) {
+        ids.push_back(neighbor.vertex);
+    }
+    std::sort(ids.begin(), ids.end());
+    CHECK(ids == std::vector<int>({1, 3}));
+
+    BasicGraph<int, void> plain({{1, 2}, {2, 3}});
+    CHECK(plain.Degree(2) == 2);
+    CHECK(plain.Neighbors(1)[0].vertex == 2);
+}
+
+TEST_CASE("edge_range") {
+    Graph gr({{5, 2, 1}, {1, 5, 2}, {3, 3, 4}, {2, 3, 3}});
+    gr.AddVertex(9);
+    const Graph& view = gr;
+
+    // каждое ребро один раз, петля тоже, меньшая вершина идет первой
+    std::vector<std::tuple<int, int, int>> stored;
+    for (const Edge& e : view.Edges()) {
+        CHECK(e.from_vertex <= e.other_vertex);
+        stored.emplace_back(e.from_vertex, e.other_vertex, e.weight);
+    }
+    std::sort(stored.begin(), stored.end());
+    CHECK(stored == std::vector<std::tuple<int, int, int>>({{1, 5, 2}, {2, 3, 3}, {2, 5, 1}, {3, 3, 4}}));
+
+    std::vector<int> from;
+    for (const Edge& e : view.Edges(EdgeOrder::ByVertex)) {
+        from.push_back(e.from_vertex);
+    }
+    CHECK(from == std::vector<int>({1, 2, 2, 3}));
+    CHECK(view.AllEdges().size() == 3);
+    CHECK(gr.AllVertex() == std::vector<int>({1, 2, 3, 5, 9}));
+
+    // кэш порядка сбрасывается при изменении множества вершин
+    gr.AddVertex(0);
+    gr.AddEdge(0, 9, 7);
+    gr.RemoveVertex(1);
+    from.clear();
+    for (const Edge& e : view.Edges(EdgeOrder::ByVertex)) {
+        from.push_back(e.from_vertex);
+    }
+    CHECK(from == std::vector<int>({0, 2, 2, 3}));
+    gr.RemoveVertices({0, 9});
+    auto range = view.Edges(EdgeOrder::ByVertex);
+    CHECK(std::distance(range.begin(), range.end()) == 3);
+
+    // несколько читателей одновременно строят кэш порядка, все видят одну перестановку
+    std::vector<Edge> ring;
+    for (int v = 0; v < 500; v++) {
+        ring.emplace_back(v, (v * 7 + 3) % 500, v);
+    }
+    const Graph shared(ring, DuplicateEdges::Drop);
+    std::vector<std::vector<int>> seen(3);
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < seen.size(); r++) {
+        readers.emplace_back([&shared, &seen, r] {
+            for (const Edge& e : shared.Edges(EdgeOrder::ByVertex)) {
+                seen[r].push_back(e.from_vertex);
+            }
+        });
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    CHECK(std::is_sorted(seen[0].begin(), seen[0].end()));
+    CHECK(seen[1] == seen[0]);
+    CHECK(seen[2] == seen[0]);
+
+    BasicGraph<int, void> plain({{1, 2}, {2, 3}});
+    CHECK(std::distance(plain.Edges().begin(), plain.Edges().end()) == 2);
+    Graph empty;
+    CHECK(empty.Edges().begin() == empty.Edges().end());
+}
+
+TEST_CASE("copy_on_write") {
+    CountingResource counting;
+    {
+        std::vector<Edge> edges;
+        for (int v = 0; v < 2000; v++) {
+            edges.emplace_back(v, (v * 13 + 7) % 2000, v + 1);
+            edges.emplace_back(v, (v + 1) % 2000, v + 2);
+        }
+        Graph base(edges, DuplicateEdges::Drop, &counting);
+        std::vector<Edge> base_edges = base.AllEdges();
+
+        // копия делит с оригиналом все куски: выделяется только массив указателей на них
+        Graph copy(&counting);
+        size_t before = counting.allocations;
+        copy = base;
+        CHECK(counting.allocations - before <= 2);
+
+        // изменение ребра копирует только куски его концов
+        before = counting.allocations;
+        copy.AddEdge(0, 1000, 3);
+        copy.RemoveEdge(5, 6);
+        CHECK(counting.allocations - before < 256 * 3);
+        CHECK(copy.AllEdges().size() == base_edges.size());
+        CHECK(base.AllEdges().size() == base_edges.size());
+        CHECK(base.Degree(0) + 1 == copy.Degree(0));
+
+        copy.AddVertex(5000);
+        copy.RemoveVertex(7);
+        copy.AddEdges({Edge(5000, 8, 1), Edge(5000, 1500, 2)});
+        copy.RemoveEdges({Edge(8, 9)});
+        copy.RemoveVertices({100, 1999});
+        copy.SetHubThreshold(2);
+        CHECK(copy.Size() == 1998);
+        CHECK(base.Size() == 2000);
+        std::vector<Edge> after = base.AllEdges();
+        CHECK(after.size() == base_edges.size());
+        for (size_t i = 0; i < after.size(); i++) {
+            CHECK(after[i].from_vertex == base_edges[i].from_vertex);
+            CHECK(after[i].other_vertex == base_edges[i].other_vertex);
+            CHECK(after[i].weight == base_edges[i].weight);
+        }
+
+        // изменения оригинала тоже не видны в копии
+        Graph second = copy;
+        size_t edges_in_second = second.AllEdges().size();
+        copy.RemoveVertex(0);
+        CHECK(second.AllEdges().size() == edges_in_second);
+        CHECK(second.Degree(0) == base.Degree(0) - 1);
+    }
+    CHECK(counting.live == 0);
+}
+
+TEST_CASE("versioned_graph") {
+    std::vector<Edge> chain;
+    for (int v = 1; v < 1000; v++) {
+        chain.emplace_back(v - 1, v, v);
+    }
+    VersionedGraph versioned{Graph(chain)};
+    VersionedGraph::Snapshot first = versioned.Acquire();
+    CHECK(first.Version() == 0);
+
+    // читатели проверяют, что каждая версия целиком соответствует своему номеру, пока писатель добавляет ребра
+    const int commits = 200;
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+            while (!done.load()) {
+                VersionedGraph::Snapshot snapshot = versioned.Acquire();
+                if (snapshot.Version() < last || snapshot->AllEdges().size() != 999 + snapshot.Version()) {
+                    failures++;
+                }
+                last = snapshot.Version();
+                if (last % 50 == 0 && snapshot->FindMST().AllEdges().size() != 999) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < commits; i++) {
+        versioned.Writer().AddEdge(i, i + 2, 5000 + i);
+        CHECK(versioned.Commit() == uint64_t(i + 1));
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK(failures == 0);
+
+    // старая версия не видит изменений, а новая видит все
+    CHECK(first->AllEdges().size() == 999);
+    CHECK(first->Degree(0) == 1);
+    VersionedGraph::Snapshot last = versioned.Acquire();
+    CHECK(last.Version() == commits);
+    CHECK(last->AllEdges().size() == 999 + commits);
+    versioned.Writer().RemoveVertex(0);
+    CHECK(versioned.Acquire()->Size() == 1000);
+    versioned.Commit();
+    CHECK(versioned.Acquire()->Size() == 999);
+    CHECK(last->Size() == 1000);
+}
+
+TEST_CASE("subgraph_view") {
+    // два треугольника, связанные тяжелым ребром 3-4, и петля
+    Graph gr({{1, 2, 1}, {2, 3, 2}, {1, 3, 3}, {3, 4, 10}, {4, 5, 1}, {5, 6, 1}, {4, 6, 5}, {6, 6, 1}});
+
+    SubgraphView light(gr);
+    light.FilterEdges([](const Edge& e) {
+        return e.weight <= 2;
+    });
+    CHECK(light.Size() == 6);
+    CHECK(light.AllEdges().size() == 4);
+    CHECK_THROWS(light.FindMST());
+
+    SubgraphView left(gr);
+    left.KeepVertices({1, 2, 3});
+    CHECK(left.Size() == 3);
+    CHECK(left.AllVertex() == std::vector<int>({1, 2, 3}));
+    CHECK(left.AllEdges().size() == 3);
+    Graph mst = left.FindMST();
+    CHECK(mst.Size() == 3);
+    int total = 0;
+    for (auto& e : mst.AllEdges()) {
+        total += e.weight;
+    }
+    CHECK(total == 3);
+    CHECK_THROWS(SubgraphView(gr).KeepVertices({1, 100}));
+
+    // фильтры складываются, представление над снимком ведет себя так же
+    FrozenGraph frozen = gr.Freeze();
+    SubgraphView right(frozen);
+    right.FilterVertices([](int v) {
+        return v >= 4;
+    }).FilterEdges([](const Edge& e) {
+        return e.weight < 5;
+    });
+    CHECK(right.Size() == 3);
+    CHECK(right.AllEdges().size() == 2);
+    FrozenGraph right_frozen = right.Freeze();
+    CHECK(right_frozen.Size() == 3);
+    CHECK(right_frozen.AllEdges().size() == 2);
+    CHECK(right.FindMST().AllEdges().size() == 2);
+
+    // каждый алгоритм дает на представлении дерево того же веса, а на несвязном подграфе бросает исключение
+    SubgraphView whole(gr);
+    whole.FilterEdges([](const Edge& e) {
+        return e.from_vertex != e.other_vertex;
+    });
+    for (MstAlgorithm algorithm : {MstAlgorithm::Auto, MstAlgorithm::Kruskal, MstAlgorithm::Prim,
+                                   MstAlgorithm::FilterKruskal, MstAlgorithm::Boruvka}) {
+        Graph tree = whole.FindMST(algorithm);
+        int weight = 0;
+        for (auto& e : tree.AllEdges()) {
+            weight += e.weight;
+        }
+        CHECK(tree.Size() == 6);
+        CHECK(weight == 15);
+        CHECK(left.FindMST(algorithm).AllEdges().size() == 2);
+        CHECK_THROWS(light.FindMST(algorithm));
+    }
+
+    // точечные запросы видят только оставленные вершины и ребра, над графом и над снимком одинаково
+    CHECK(left.HasVertex(2));
+    CHECK_FALSE(left.HasVertex(4));
+    CHECK_FALSE(left.HasVertex(100));
+    CHECK(left.HasEdge(3, 1));
+    CHECK_FALSE(left.HasEdge(3, 4));
+    CHECK(left.GetWeight(3, 1) == 3);
+    CHECK_THROWS(left.GetWeight(3, 4));
+    CHECK(left.Degree(3) == 2);
+    CHECK_THROWS(left.Degree(4));
+    CHECK_FALSE(light.HasEdge(1, 3));
+    CHECK(light.HasEdge(6, 6));
+    CHECK(light.Degree(6) == 2);
+    CHECK(light.Edges().size() == 5);
+    CHECK(right.HasVertex(6));
+    CHECK_FALSE(right.HasVertex(3));
+    CHECK(right.HasEdge(6, 5));
+    CHECK_FALSE(right.HasEdge(4, 6));
+    CHECK(right.GetWeight(6, 6) == 1);
+    CHECK(right.Degree(6) == 2);
+    std::vector<int> around;
+    for (auto& neighbor : right.Neighbors(6)) {
+        around.push_back(neighbor.vertex);
+    }
+    std::sort(around.begin(), around.end());
+    CHECK(around == std::vector<int>({5, 6}));
+    CHECK_THROWS(right.Neighbors(1));
+    for (const Edge& e : right.Edges()) {
+        CHECK(e.from_vertex <= e.other_vertex);
+        CHECK(right.HasEdge(e.other_vertex, e.from_vertex));
+    }
+
+    // исходный граф не меняется, невзвешенные графы фильтруются так же
+    CHECK(gr.Size() == 6);
+    CHECK(gr.AllEdges().size() == 7);
+    BasicGraph<int, void> plain({{1, 2}, {2, 3}, {3, 1}});
+    SubgraphView plain_view(plain);
+    plain_view.KeepVertices({1, 2});
+    CHECK(plain_view.FindMST().AllEdges().size() == 1);
+    CHECK(plain_view.FindMST(MstAlgorithm::Boruvka).AllEdges().size() == 1);
+    CHECK(plain_view.FindMST(MstAlgorithm::Prim).AllEdges().size() == 1);
+    CHECK(plain_view.HasEdge(2, 1));
+    CHECK_FALSE(plain_view.HasEdge(2, 3));
+    CHECK(plain_view.Neighbors(1).size() == 1);
+
+    // на случайном подграфе Прим и Краскал без снимка дают дерево того же веса, что и по снимку
+    std::vector<Edge> edges;
+    for (int v = 1; v < 400; v++) {
+        edges.emplace_back(v - 1, v, rand() % 20 + 1);
+        edges.emplace_back(rand() % 400, rand() % 400, rand() % 20 + 1);
+    }
+    Graph big(edges, DuplicateEdges::Drop);
+    SubgraphView odd_light(big);
+    odd_light.FilterEdges([](const Edge& e) {
+        return e.weight % 2 == 1 || e.other_vertex == e.from_vertex + 1;
+    });
+    auto weight_of = [](const Graph& tree) {
+        long long sum = 0;
+        for (auto& e : tree.AllEdges()) {
+            sum += e.weight;
+        }
+        return sum;
+    };
+    long long expected = weight_of(odd_light.Freeze().FindMST(MstAlgorithm::Kruskal));
+    CHECK(weight_of(odd_light.FindMST(MstAlgorithm::Prim)) == expected);
+    CHECK(weight_of(odd_light.FindMST(MstAlgorithm::Kruskal)) == expected);
+    CHECK(odd_light.FindMST().Size() == 400);
+}
+
+TEST_CASE("extract_subgraph") {
+    Graph gr({{1, 2, 1}, {2, 3, 2}, {1, 3, 3}, {3, 4, 10}, {4, 5, 1}, {5, 6, 1}, {4, 6, 5}, {6, 6, 1}});
+
+    Graph left = gr.InducedSubgraph({3, 1, 2, 1});
+    CHECK(left.Size() == 3);
+    CHECK(left.AllEdges().size() == 3);
+    CHECK(left.Degree(3) == 2);
+    CHECK_THROWS(gr.InducedSubgraph({1, 100}));
+
+    Graph right = gr.InducedSubgraph({4, 5, 6}, SubgraphIds::Renumber);
+    CHECK(right.AllVertex() == std::vector<int>({0, 1, 2}));
+    CHECK(right.Degree(2) == 3);
+
+    Graph light = gr.FilterEdges([](const Edge& e) {
+        return e.weight <= 2;
+    });
+    CHECK(light.Size() == 6);
+    CHECK(light.AllEdges().size() == 4);
+    CHECK(light.Degree(4) == 1);
+
+    // совпадает с представлением на случайном графе, в том числе у хабов
+    std::vector<Edge> edges;
+    for (int i = 0; i < 20000; i++) {
+        int from_v = rand() % 2000;
+        int to_v = i % 50 == 0 ? 0 : rand() % 2000;
+        edges.emplace_back(from_v, to_v, rand() % 100 + 1);
+    }
+    Graph big(edges, DuplicateEdges::Drop);
+    big.SetHubThreshold(8);
+    std::vector<int> half;
+    for (int v : big.AllVertex()) {
+        if (v % 2 == 0) {
+            half.push_back(v);
+        }
+    }
+    auto sorted = [](std::vector<Edge> all) {
+        std::vector<std::tuple<int, int, int>> result;
+        for (auto& e : all) {
+            result.emplace_back(e.from_vertex, e.other_vertex, e.weight);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    SubgraphView view(big);
+    view.KeepVertices(half).FilterEdges([](const Edge& e) {
+        return e.weight > 30;
+    });
+    Graph induced = big.InducedSubgraph(half).FilterEdges([](const Edge& e) {
+        return e.weight > 30;
+    });
+    CHECK(sorted(induced.AllEdges()) == sorted(view.AllEdges()));
+    CHECK(induced.Size() == view.Size());
+    CHECK(induced.HubThreshold() == 8);
+    for (int v : half) {
+        for (auto neighbor : induced.Neighbors(v)) {
+            CHECK(neighbor.weight > 30);
+        }
+    }
+    CHECK(big.InducedSubgraph(half, SubgraphIds::Renumber).AllEdges().size() ==
+          big.InducedSubgraph(half).AllEdges().size());
+}
+
+TEST_CASE("weight_index") {
+    Graph gr({{1, 2, 5}, {2, 3, 2}, {1, 3, 7}, {3, 4, 2}, {4, 4, 1}});
+    CHECK_FALSE(gr.HasWeightIndex());
+    CHECK_THROWS(gr.LightestEdges(1));
+
+    gr.EnableWeightIndex();
+    CHECK(gr.HasWeightIndex());
+    std::vector<Edge> light = gr.LightestEdges(3);
+    REQUIRE(light.size() == 3);
+    CHECK((light[0].from_vertex == 4 && light[0].other_vertex == 4 && light[0].weight == 1));
+    CHECK((light[1].from_vertex == 2 && light[1].other_vertex == 3));
+    CHECK((light[2].from_vertex == 3 && light[2].other_vertex == 4));
+    CHECK(gr.EdgesInWeightRange(2, 5).size() == 3);
+    CHECK(gr.EdgesInWeightRange(8, 10).empty());
+    CHECK(gr.LightestEdges(100).size() == 5);
+
+    // индекс следует за изменениями графа, копия не видит изменений оригинала
+    Graph copy = gr;
+    gr.AddEdge(2, 4, 3);
+    gr.RemoveEdge(3, 2);
+    CHECK(gr.EdgesInWeightRange(2, 3).size() == 2);
+    CHECK(copy.EdgesInWeightRange(2, 3).size() == 2);
+    CHECK(copy.EdgesInWeightRange(3, 3).empty());
+    gr.RemoveVertex(4);
+    CHECK(gr.LightestEdges(100).size() == 2);
+    CHECK(gr.LightestEdges(1)[0].weight == 5);
+
+    std::stringstream stream;
+    stream << copy;
+    stream >> gr;
+    CHECK(gr.HasWeightIndex());
+    CHECK(gr.LightestEdges(100).size() == 5);
+    gr.DisableWeightIndex();
+    CHECK_THROWS(gr.EdgesInWeightRange(1, 10));
+
+    // на случайных изменениях индекс совпадает с отсортированными ребрами графа
+    std::vector<Edge> edges;
+    for (int i = 0; i < 3000; i++) {
+        edges.emplace_back(rand() % 300, rand() % 300, rand() % 50 + 1);
+    }
+    Graph big(edges, DuplicateEdges::Drop);
+    Graph plain = big;
+    big.EnableWeightIndex();
+    std::vector<Edge> batch;
+    for (int i = 0; i < 200; i++) {
+        int from_v = rand() % 300;
+        int to_v = rand() % 300;
+        try {
+            if (rand() % 2 == 0) {
+                big.AddEdge(from_v, to_v, rand() % 50 + 1);
+            } else if (big.Degree(from_v) > 0) {
+                big.RemoveEdge(from_v, (*big.Neighbors(from_v).begin()).vertex);
+            }
+        } catch (...) {}
+    }
+    big.RemoveVertices({1, 2, 3});
+    for (int v = 400; v < 410; v++) {
+        big.AddVertex(v);
+        batch.emplace_back(v, v - 390, v % 7 + 1);
+    }
+    big.AddEdges(batch);
+    batch.resize(5);
+    big.RemoveEdges(batch);
+
+    std::vector<std::tuple<int, int, int>> expected;
+    for (const Edge& e : big.Edges()) {
+        expected.emplace_back(e.weight, std::min(e.from_vertex, e.other_vertex), std::max(e.from_vertex, e.other_vertex));
+    }
+    std::sort(expected.begin(), expected.end());
+    std::vector<std::tuple<int, int, int>> indexed;
+    for (auto& e : big.EdgesInWeightRange(1, 50)) {
+        indexed.emplace_back(e.weight, e.from_vertex, e.other_vertex);
+    }
+    CHECK(indexed == expected);
+
+    // дерево, построенное по индексу, весит столько же, сколько дерево, построенное сортировкой
+    auto total = [](const Graph& tree) {
+        long long sum = 0;
+        for (auto& e : tree.AllEdges()) {
+            sum += e.weight;
+        }
+        return sum;
+    };
+    plain.EnableWeightIndex();
+    Graph indexed_tree = plain.FindMST();
+    plain.DisableWeightIndex();
+    CHECK(total(indexed_tree) == total(plain.FindMST()));
+    CHECK(indexed_tree.Size() == plain.Size());
+
+    // копия, которая меняет ребро, отпускает общий индекс, а не копирует его, и строит свой при первом запросе
+    CountingResource counting;
+    {
+        std::vector<Edge> ring;
+        for (int v = 0; v < 2000; v++) {
+            ring.emplace_back(v, (v + 1) % 2000, v % 97 + 1);
+        }
+        Graph original(ring, DuplicateEdges::Drop, &counting);
+        original.EnableWeightIndex();
+        Graph copy(original, &counting);
+        size_t before = counting.allocations;
+        copy.SetWeight(0, 1, 500);
+        copy.AddEdge(0, 2, 1);
+        CHECK(counting.allocations - before < 100);
+        CHECK(copy.HasWeightIndex());
+        CHECK(copy.LightestEdges(1)[0].weight == 1);
+        CHECK(copy.EdgesInWeightRange(500, 500).size() == 1);
+        CHECK(copy.EdgesInWeightRange(1, 1000).size() == 2001);
+        CHECK(original.EdgesInWeightRange(500, 500).empty());
+        CHECK(original.EdgesInWeightRange(1, 1000).size() == 2000);
+        CHECK(total(copy.FindMST()) == total(copy.FindMST(MstAlgorithm::Prim)));
+
+        // версии графа тоже не копируют индекс: рабочая копия строит свой, опубликованная версия сохраняет свой
+        VersionedGraph versioned{original};
+        VersionedGraph::Snapshot first = versioned.Acquire();
+        CHECK(first->LightestEdges(3).size() == 3);
+        versioned.Writer().RemoveEdge(0, 1);
+        versioned.Commit();
+        CHECK(versioned.Acquire()->EdgesInWeightRange(1, 1000).size() == 1999);
+        CHECK(first->EdgesInWeightRange(1, 1000).size() == 2000);
+    }
+    CHECK(counting.live == 0);
+}
+
+TEST_CASE("properties") {
+    Graph gr({{1, 2, 5}, {2, 3, 2}, {1, 3, 7}, {3, 4, 2}, {4, 4, 1}});
+    PropertyColumn<std::string>& label = gr.MutableVertexProperty<std::string>("label");
+    CHECK(label.size() == 4);
+    for (int v : gr.AllVertex()) {
+        label[gr.VertexSlot(v)] = "v" + std::to_string(v);
+    }
+    CHECK(gr.EdgeProperty<double>("capacity").size() == 5);
+    for (const Edge& e : gr.Edges()) {
+        gr.SetEdgeProperty<double>(e.from_vertex, e.other_vertex, "capacity", e.weight * 10);
+    }
+    CHECK_THROWS(gr.VertexProperty<int>("label"));
+    CHECK_THROWS(gr.SetVertexProperty<int>(1, "label", 1));
+    CHECK_THROWS(gr.SetVertexProperty<std::string>(100, "label", "v100"));
+    CHECK_THROWS(gr.SetEdgeProperty<double>(1, 4, "capacity", 1));
+    CHECK_THROWS(std::as_const(gr).EdgeProperty<double>("missing"));
+    CHECK_THROWS(gr.EdgeSlot(1, 4));
+
+    // значения переезжают вместе с вершинами и ребрами, копия их не видит
+    Graph copy = gr;
+    gr.RemoveVertex(1);
+    gr.AddVertex(5);
+    gr.AddEdge(5, 4, 3);
+    gr.RemoveEdge(2, 3);
+    const Graph& view = gr;
+    CHECK(view.VertexProperty<std::string>("label").size() == 4);
+    CHECK(view.VertexProperty<std::string>("label")[gr.VertexSlot(4)] == "v4");
+    CHECK(view.VertexProperty<std::string>("label")[gr.VertexSlot(5)].empty());
+    CHECK(view.EdgeProperty<double>("capacity").size() == 3);
+    CHECK(view.EdgeProperty<double>("capacity")[gr.EdgeSlot(4, 3)] == 20);
+    CHECK(view.EdgeProperty<double>("capacity")[gr.EdgeSlot(4, 4)] == 10);
+    CHECK(view.EdgeProperty<double>("capacity")[gr.EdgeSlot(4, 5)] == 0);
+    Edge slot_edge = gr.SlotEdge(gr.EdgeSlot(5, 4));
+    CHECK((slot_edge.from_vertex == 4 && slot_edge.other_vertex == 5 && slot_edge.weight == 3));
+    CHECK(std::as_const(copy).VertexProperty<std::string>("label")[copy.VertexSlot(1)] == "v1");
+    CHECK(std::as_const(copy).EdgeProperty<double>("capacity").size() == 5);
+    CHECK(gr.RemoveEdgeProperty("capacity"));
+    CHECK_FALSE(gr.RemoveEdgeProperty("capacity"));
+    CHECK_THROWS(gr.EdgeSlot(4, 3));
+
+    // запись после копирования графа или публикации версии не видна ни копии, ни опубликованной версии
+    Graph colored({{1, 2, 1}, {2, 3, 1}});
+    colored.SetVertexProperty<int>(1, "color", 7);
+    Graph colored_copy = colored;
+    colored.SetVertexProperty<int>(1, "color", 42);
+    colored.MutableEdgeProperty<int>("mark")[colored.EdgeSlot(1, 2)] = 5;
+    CHECK(std::as_const(colored_copy).VertexProperty<int>("color")[colored_copy.VertexSlot(1)] == 7);
+    CHECK_THROWS(std::as_const(colored_copy).EdgeProperty<int>("mark"));
+    CHECK(colored.VertexProperty<int>("color")[colored.VertexSlot(1)] == 42);
+    VersionedGraph versioned{colored};
+    versioned.Commit();
+    VersionedGraph::Snapshot published = versioned.Acquire();
+    versioned.Writer().SetVertexProperty<int>(1, "color", 9);
+    versioned.Writer().MutableVertexProperty<int>("color")[versioned.Writer().VertexSlot(2)] = 3;
+    CHECK(published->VertexProperty<int>("color")[published->VertexSlot(1)] == 42);
+    CHECK(published->VertexProperty<int>("color")[published->VertexSlot(2)] == 0);
+    CHECK(versioned.Writer().VertexProperty<int>("color")[versioned.Writer().VertexSlot(1)] == 9);
+
+    // на случайных изменениях, в том числе пакетных, значения совпадают с таблицами по номерам вершин
+    std::vector<Edge> edges;
+    for (int i = 0; i < 3000; i++) {
+        edges.emplace_back(rand() % 300, rand() % 300, rand() % 50 + 1);
+    }
+    Graph big(edges, DuplicateEdges::Drop);
+    std::map<int, int> vertex_value;
+    std::map<std::pair<int, int>, int> edge_value;
+    auto key = [](int from_v, int to_v) {
+        return std::make_pair(std::min(from_v, to_v), std::max(from_v, to_v));
+    };
+    for (int v : big.AllVertex()) {
+        big.SetVertexProperty<int>(v, "id", v);
+        vertex_value[v] = v;
+    }
+    for (const Edge& e : big.Edges()) {
+        big.SetEdgeProperty<int>(e.from_vertex, e.other_vertex, "sum", e.from_vertex + e.other_vertex);
+        edge_value[key(e.from_vertex, e.other_vertex)] = e.from_vertex + e.other_vertex;
+    }
+    for (int i = 0; i < 300; i++) {
+        int from_v = rand() % 320;
+        int to_v = rand() % 320;
+        try {
+            switch (rand() % 4) {
+                case 0:
+                    big.AddEdge(from_v, to_v, 1);
+                    edge_value[key(from_v, to_v)] = 0;
+                    break;
+                case 1:
+                    big.RemoveEdge(from_v, to_v);
+                    edge_value.erase(key(from_v, to_v));
+                    break;
+                case 2:
+                    big.RemoveVertex(from_v);
+                    vertex_value.erase(from_v);
+                    for (auto it = edge_value.begin(); it != edge_value.end();) {
+                        it = it->first.first == from_v || it->first.second == from_v ? edge_value.erase(it) : std::next(it);
+                    }
+                    break;
+                default:
+                    big.AddVertex(from_v);
+                    vertex_value[from_v] = 0;
+            }
+        } catch (...) {}
+    }
+    std::vector<int> batch_vertices;
+    for (auto& [v, value] : vertex_value) {
+        if (batch_vertices.size() < 20 && v % 3 == 0) {
+            batch_vertices.push_back(v);
+        }
+    }
+    std::vector<Edge> batch_edges;
+    for (auto it = vertex_value.begin(); std::next(it) != vertex_value.end() && batch_edges.size() < 10; it++) {
+        int from_v = it->first;
+        int to_v = std::next(it)->first;
+        if (edge_value.count(key(from_v, to_v)) == 0) {
+            batch_edges.emplace_back(from_v, to_v, 1);
+            edge_value[key(from_v, to_v)] = 0;
+        }
+    }
+    big.AddEdges(batch_edges);
+    batch_edges.resize(batch_edges.size() / 2);
+    big.RemoveEdges(batch_edges);
+    for (auto& e : batch_edges) {
+        edge_value.erase(key(e.from_vertex, e.other_vertex));
+    }
+    big.RemoveVertices(batch_vertices);
+    for (int v : batch_vertices) {
+        vertex_value.erase(v);
+        for (auto it = edge_value.begin(); it != edge_value.end();) {
+            it = it->first.first == v || it->first.second == v ? edge_value.erase(it) : std::next(it);
+        }
+    }
+
+    const Graph& big_view = big;
+    CHECK(big_view.VertexProperty<int>("id").size() == vertex_value.size());
+    for (auto& [v, value] : vertex_value) {
+        CHECK(big_view.VertexProperty<int>("id")[big.VertexSlot(v)] == value);
+    }
+    CHECK(big_view.EdgeProperty<int>("sum").size() == edge_value.size());
+    for (auto& [e, value] : edge_value) {
+        CHECK(big_view.EdgeProperty<int>("sum")[big.EdgeSlot(e.first, e.second)] == value);
+    }
+}
+
+TEST_CASE("edge_handle") {
+    Graph gr;
+    for (int v = 1; v <= 6; v++) {
+        gr.AddVertex(v);
+    }
+    Graph::EdgeHandle a = gr.AddEdge(1, 2, 5);
+    Graph::EdgeHandle b = gr.AddEdge(2, 3, 7);
+    Graph::EdgeHandle loop = gr.AddEdge(4, 4, 1);
+    gr.AddEdge(2, 4, 2);
+    CHECK((a.From() == 1 && a.To() == 2));
+
+    gr.SetWeight(a, 10);
+    CHECK((*gr.Neighbors(1).begin()).weight == 10);
+    CHECK((*gr.Neighbors(2).begin()).weight == 10);
+    gr.SetWeight(3, 2, 8);
+    gr.SetWeight(loop, 3);
+    CHECK((*gr.Neighbors(4).begin()).weight == 2);
+
+    // ручка переживает сдвиги полуребер и переезд вершин
+    gr.AddEdge(2, 5, 1);
+    Graph::EdgeHandle moved = gr.AddEdge(1, 6, 1);
+    gr.RemoveVertex(5);
+    gr.SetWeight(b, 9);
+    gr.SetWeight(moved, 6);
+    CHECK((*gr.Neighbors(6).begin()).weight == 6);
+    CHECK(gr.FindEdgeHandle(3, 2).To() == 2);
+    gr.RemoveEdge(b);
+    CHECK(gr.Degree(3) == 0);
+    CHECK_THROWS(gr.RemoveEdge(b));
+    CHECK_THROWS(gr.SetWeight(b, 1));
+    CHECK_THROWS(gr.RemoveEdge(Graph::EdgeHandle()));
+    CHECK_THROWS(gr.FindEdgeHandle(1, 3));
+    gr.RemoveEdge(loop);
+    CHECK(gr.Degree(4) == 1);
+
+    // индекс весов и свойства ребер следуют за изменением веса по ручке
+    gr.EnableWeightIndex();
+    gr.SetEdgeProperty<int>(1, 2, "flow", 42);
+    gr.SetWeight(a, 100);
+    CHECK(gr.LightestEdges(100).back().weight == 100);
+    CHECK(gr.EdgesInWeightRange(10, 10).empty());
+    CHECK(gr.EdgeProperty<int>("flow")[gr.EdgeSlot(1, 2)] == 42);
+
+    // у хабов полуребра переставляются при удалении, ручки все равно остаются верными
+    Graph hub;
+    hub.SetHubThreshold(4);
+    std::vector<Graph::EdgeHandle> handles;
+    for (int v = 0; v <= 40; v++) {
+        hub.AddVertex(v);
+    }
+    for (int v = 1; v <= 40; v++) {
+        handles.push_back(hub.AddEdge(0, v, v));
+    }
+    for (int k = 0; k < 40; k += 2) {
+        hub.RemoveEdge(handles[k]);
+    }
+    for (int k = 1; k < 40; k += 2) {
+        hub.SetWeight(handles[k], 1000 + k);
+    }
+    for (auto neighbor : hub.Neighbors(0)) {
+        CHECK(neighbor.vertex % 2 == 0);
+        CHECK(neighbor.weight == 1000 + neighbor.vertex - 1);
+    }
+    CHECK(hub.Degree(0) == 20);
+}
+
+TEST_CASE("lookups") {
+    Graph gr({{1, 2, 5}, {2, 3, 2}, {3, 3, 4}});
+    const Graph& view = gr;
+    CHECK(view.Size() == 3);
+    CHECK(noexcept(view.Size()));
+    CHECK(noexcept(view.HasEdge(1, 2)));
+    CHECK(view.HasVertex(3));
+    CHECK_FALSE(view.HasVertex(4));
+    CHECK(view.HasEdge(2, 1));
+    CHECK(view.HasEdge(3, 3));
+    CHECK_FALSE(view.HasEdge(1, 3));
+    CHECK_FALSE(view.HasEdge(1, 4));
+    CHECK(view.GetWeight(2, 1) == 5);
+    CHECK(view.GetWeight(3, 3) == 4);
+    CHECK_THROWS(view.GetWeight(1, 3));
+
+    // хаб ищет ребро по хеш-индексу, остальные вершины - двоичным поиском
+    gr.SetHubThreshold(4);
+    for (int v = 10; v < 30; v++) {
+        gr.AddVertex(v);
+        gr.AddEdge(2, v, v);
+    }
+    for (int v = 10; v < 30; v++) {
+        CHECK(view.HasEdge(v, 2));
+        CHECK(view.GetWeight(2, v) == v);
+        CHECK_FALSE(view.HasEdge(v, 1));
+    }
+    CHECK(view.Degree(2) == 22);
+}
+
+TEST_CASE("mst_algorithms") {
+    auto total = [](const Graph& tree) {
+        long long sum = 0;
+        for (auto& e : tree.AllEdges()) {
+            sum += e.weight;
+        }
+        return sum;
+    };
+    // разреженный граф - цепочка со случайными хордами, плотный - почти полный граф на 60 вершинах
+    for (int dense = 0; dense < 2; dense++) {
+        int n = dense ? 60 : 500;
+        std::vector<Edge> edges;
+        for (int v = 1; v < n; v++) {
+            edges.emplace_back(v - 1, v, rand() % 100);
+        }
+        std::map<std::pair<int, int>, bool> used;
+        int extra = dense ? n * (n - 1) / 2 - n : 2 * n;
+        for (int i = 0; i < extra; i++) {
+            int u = rand() % n;
+            int v = rand() % n;
+            if (u + 1 < v && !used[{u, v}]) {
+                used[{u, v}] = true;
+                edges.emplace_back(u, v, rand() % 100);
+            }
+        }
+        edges.emplace_back(n / 2, n / 2, 0);
+        Graph gr(edges);
+        Graph kruskal = gr.FindMST(MstAlgorithm::Kruskal);
+        Graph prim = gr.FindMST(MstAlgorithm::Prim);
+        CHECK(prim.Size() == gr.Size());
+        CHECK(prim.AllEdges().size() == size_t(n - 1));
+        CHECK(total(prim) == total(kruskal));
+        CHECK(total(gr.FindMST()) == total(kruskal));
+        CHECK(total(gr.Freeze().FindMST(MstAlgorithm::Prim)) == total(kruskal));
+        CHECK(total(gr.Freeze().FindMST(MstAlgorithm::Kruskal)) == total(kruskal));
+
+        gr.EnableWeightIndex();
+        CHECK(total(gr.FindMST(MstAlgorithm::Prim)) == total(kruskal));
+        CHECK(total(gr.FindMST(MstAlgorithm::Auto)) == total(kruskal));
+    }
+
+    Graph disconnected({{1, 2, 1}, {2, 3, 1}, {4, 5, 1}});
+    CHECK_THROWS(disconnected.FindMST(MstAlgorithm::Prim));
+    CHECK_THROWS(disconnected.Freeze().FindMST(MstAlgorithm::Prim));
+    // у пустого графа остовное дерево пустое при любом алгоритме
+    for (MstAlgorithm algorithm : {MstAlgorithm::Auto, MstAlgorithm::Kruskal, MstAlgorithm::Prim,
+                                   MstAlgorithm::FilterKruskal, MstAlgorithm::Boruvka}) {
+        CHECK(Graph().FindMST(algorithm).Size() == 0);
+        CHECK(Graph().Freeze().FindMST(algorithm).Size() == 0);
+        CHECK(BasicGraph<int, void>().FindMST(algorithm).Size() == 0);
+        Graph indexed;
+        indexed.EnableWeightIndex();
+        CHECK(indexed.FindMST(algorithm).Size() == 0);
+    }
+    CHECK(Graph().FindMST().Size() == 0);
+
+    BasicGraph<int, void> plain({{1, 2}, {2, 3}, {3, 1}, {3, 4}});
+    CHECK(plain.FindMST(MstAlgorithm::Prim).AllEdges().size() == 3);
+    CHECK(plain.Freeze().FindMST(MstAlgorithm::Prim).AllEdges().size() == 3);
+}
+
+TEST_CASE("boruvka") {
+    // много равных весов: дерево Борувки должно совпасть с деревом Краскала ребро в ребро при любом числе потоков
+    std::vector<Edge> edges;
+    int n = 20000;
+    for (int v = 1; v < n; v++) {
+        edges.emplace_back(rand() % v, v, rand() % 4);
+    }
+    for (int i = 0; i < 3 * n; i++) {
+        int u = rand() % n;
+        int v = rand() % n;
+        if (u != v) {
+            edges.emplace_back(u, v, rand() % 4);
+        }
+    }
+    Graph gr(edges, DuplicateEdges::Drop);
+    std::vector<Edge> kruskal = gr.FindMST(MstAlgorithm::Kruskal).AllEdges();
+    std::vector<Edge> boruvka = gr.FindMST(MstAlgorithm::Boruvka).AllEdges();
+    REQUIRE(boruvka.size() == size_t(n - 1));
+    REQUIRE(boruvka.size() == kruskal.size());
+    bool same = true;
+    for (size_t i = 0; i < kruskal.size(); i++) {
+        same &= std::tie(kruskal[i].from_vertex, kruskal[i].other_vertex, kruskal[i].weight) ==
+                std::tie(boruvka[i].from_vertex, boruvka[i].other_vertex, boruvka[i].weight);
+    }
+    CHECK(same);
+
+    CHECK_THROWS(Graph({{1, 2, 1}, {3, 4, 1}}).FindMST(MstAlgorithm::Boruvka));
+    BasicGraph<int, void> plain({{1, 2}, {2, 3}, {3, 1}, {3, 4}});
+    CHECK(plain.FindMST(MstAlgorithm::Boruvka).AllEdges().size() == 3);
+}
+
+TEST_CASE("filter_kruskal") {
+    // разреженный граф, похожий на дорожную сеть: решетка со случайными весами и редкими диагоналями
+    int side = 150;
+    std::vector<Edge> edges;
+    for (int x = 0; x < side; x++) {
+        for (int y = 0; y < side; y++) {
+            int v = x * side + y;
+            if (x + 1 < side) {
+                edges.emplace_back(v, v + side, rand() % 50 + 1);
+            }
+            if (y + 1 < side) {
+                edges.emplace_back(v, v + 1, rand() % 50 + 1);
+            }
+            if (x + 1 < side && y + 1 < side && rand() % 8 == 0) {
+                edges.emplace_back(v, v + side + 1, rand() % 50 + 1);
+            }
+        }
+    }
+    Graph gr(edges);
+    std::vector<Edge> kruskal = gr.FindMST(MstAlgorithm::Kruskal).AllEdges();
+    std::vector<Edge> filtered = gr.FindMST(MstAlgorithm::FilterKruskal).AllEdges();
+    REQUIRE(filtered.size() == size_t(side * side - 1));
+    REQUIRE(filtered.size() == kruskal.size());
+    bool same = true;
+    for (size_t i = 0; i < kruskal.size(); i++) {
+        same &= std::tie(kruskal[i].from_vertex, kruskal[i].other_vertex, kruskal[i].weight) ==
+                std::tie(filtered[i].from_vertex, filtered[i].other_vertex, filtered[i].weight);
+    }
+    CHECK(same);
+
+    // вершина 0 остается без соседей: все отрезки обработаны, а дерево так и не собрано
+    gr.RemoveVertex(1);
+    gr.RemoveVertex(side);
+    gr.RemoveVertex(side + 1);
+    CHECK_THROWS(gr.FindMST(MstAlgorithm::FilterKruskal));
+}
+
+TEST_CASE("mst_weight_keys") {
+    // отрицательные веса и веса во весь диапазон int64_t: ключи поразрядной сортировки считаются от наименьшего веса,
+    // а если разброс с номером ребра не помещается в 64 бита, ребра сортируются сравнениями
+    using LongGraph = BasicGraph<int, int64_t>;
+    // у всех минимальных остовных деревьев одинаковый набор весов; сравниваются наборы, а не суммы, чтобы сумма
+    // огромных весов не переполнилась
+    auto weights = [](const LongGraph& tree) {
+        std::vector<int64_t> result;
+        for (auto& e : tree.AllEdges()) {
+            result.push_back(e.weight);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    for (int64_t scale : {int64_t(1), int64_t(1) << 58}) {
+        std::vector<LongGraph::Edge> edges;
+        for (int v = 1; v < 300; v++) {
+            edges.emplace_back(v - 1, v, (rand() % 21 - 10) * scale);
+            edges.emplace_back(rand() % v, v, (rand() % 21 - 10) * scale);
+        }
+        LongGraph gr(edges, DuplicateEdges::Drop);
+        LongGraph kruskal = gr.FindMST(MstAlgorithm::Kruskal);
+        CHECK(kruskal.AllEdges().size() == 299);
+        CHECK(weights(kruskal) == weights(gr.FindMST(MstAlgorithm::Prim)));
+    }
+}
+
+TEST_CASE("disjoint_set") {
+    DisjointSet sets(10);
+    CHECK(sets.Size() == 10);
+    CHECK(sets.Count() == 10);
+    CHECK(sets.Union(1, 2));
+    CHECK(sets.Union(3, 4));
+    CHECK(sets.Union(2, 4));
+    CHECK_FALSE(sets.Union(1, 3));
+    CHECK(sets.Count() == 7);
+    CHECK(sets.Same(1, 4));
+    CHECK_FALSE(sets.Same(1, 5));
+    CHECK(sets.SetSize(3) == 4);
+    CHECK(sets.SetSize(9) == 1);
+
+    uint32_t x = sets.Add();
+    CHECK(x == 10);
+    CHECK(sets.Count() == 8);
+    CHECK(sets.Union(x, 1));
+    CHECK(sets.SetSize(4) == 5);
+
+    // компоненты связности случайного графа: пакетный поиск и поиск без сжатия путей дают те же корни
+    int n = 3000;
+    DisjointSet components(n);
+    for (int i = 0; i < n; i++) {
+        components.Union(rand() % n, rand() % n);
+    }
+    std::vector<uint32_t> xs(n);
+    for (int i = 0; i < n; i++) {
+        xs[i] = rand() % n;
+    }
+    std::vector<uint32_t> roots(n);
+    components.Find(xs.data(), xs.size(), roots.data());
+    bool same = true;
+    size_t total = 0;
+    for (int i = 0; i < n; i++) {
+        same &= roots[i] == components.Root(xs[i]) && roots[i] == components.Find(xs[i]);
+        if (components.Find(i) == uint32_t(i)) {
+            total += components.SetSize(i);
+        }
+    }
+    CHECK(same);
+    CHECK(total == size_t(n));
+
+    sets.Reset();
+    CHECK(sets.Count() == 11);
+    CHECK_FALSE(sets.Same(1, 2));
+}
@@ -0,0 +1,171 @@
+#ifndef GRAPH_HASH_INDEX_H
+#define GRAPH_HASH_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+
+/*!
+    \brief Класс HashIndex реализует хеш-таблицу с открытой адресацией, сопоставляющую ключу индекс в массиве.
+    \details Таблица использует линейное пробирование и удаление со сдвигом назад, поэтому не хранит "надгробий".
+    Все ячейки лежат в одном непрерывном массиве, что дает хорошую локальность при поиске.
+    * slots - массив ячеек (ключ, значение), значение kEmpty означает пустую ячейку; память берется из memory_resource,
+    переданного в конструктор
+    * count - количество занятых ячеек
+    * shift - сдвиг для мультипликативного (фибоначчиева) хеширования
+*/
+template <class Key>
+class HashIndex {
+public:
+    static constexpr uint32_t kNotFound = UINT32_MAX;
+
+    HashIndex() = default;
+    explicit HashIndex(std::pmr::memory_resource* resource) : slots(resource) {}
+    HashIndex(const HashIndex& other, std::pmr::memory_resource* resource)
+        : slots(other.slots, resource), count(other.count), shift(other.shift) {}
+
+    /*!
+     * Поиск значения по ключу
+     * @param key ключ
+     * @return Значение, сопоставленное ключу, или kNotFound, если ключа нет в таблице
+     */
+    uint32_t Find(const Key& key) const noexcept {
+        if (this->slots.empty()) {
+            return kNotFound;
+        }
+        for (size_t i = this->home(key);; i = this->next(i)) {
+            const Slot& slot = this->slots[i];
+            if (slot.value == kEmpty) {
+                return kNotFound;
+            }
+            if (slot.key == key) {
+                return slot.value;
+            }
+        }
+    }
+
+    /*!
+     * Добавляет ключ в таблицу или перезаписывает значение существующего ключа
+     * @param key ключ
+     * @param value значение, должно быть меньше kNotFound
+     */
+    void Assign(const Key& key, uint32_t value) {
+        if ((this->count + 1) * 2 > this->slots.size()) {
+            this->rehash(this->slots.empty() ? kMinCapacity : this->slots.size() * 2);
+        }
+        for (size_t i = this->home(key);; i = this->next(i)) {
+            Slot& slot = this->slots[i];
+            if (slot.value == kEmpty) {
+                slot.key = key;
+                slot.value = value;
+                this->count++;
+                return;
+            }
+            if (slot.key == key) {
+                slot.value = value;
+                return;
+            }
+        }
+    }
+
+    /*!
+     * Удаляет ключ из таблицы
+     * @param key ключ
+     * @return true, если ключ был в таблице
+     */
+    bool Erase(const Key& key) noexcept {
+        if (this->slots.empty()) {
+            return false;
+        }
+        size_t i = this->home(key);
+        while (true) {
+            if (this->slots[i].value == kEmpty) {
+                return false;
+            }
+            if (this->slots[i].key == key) {
+                break;
+            }
+            i = this->next(i);
+        }
+
+        // сдвигаем назад элементы цепочки, чтобы не оставлять дыр при поиске
+        size_t hole = i;
+        for (size_t j = this->next(hole); this->slots[j].value != kEmpty; j = this->next(j)) {
+            size_t h = this->home(this->slots[j].key);
+            // элемент j можно перенести в дыру, если его домашняя ячейка не лежит в (hole, j]
+            bool between = (hole < j) ? (hole < h && h <= j) : (hole < h || h <= j);
+            if (!between) {
+                this->slots[hole] = this->slots[j];
+                hole = j;
+            }
+        }
+        this->slots[hole].value = kEmpty;
+        this->count--;
+        return true;
+    }
+
+    /*!
+     * Резервирует место под указанное количество ключей без перехеширования
+     * @param n количество ключей
+     */
+    void Reserve(size_t n) {
+        size_t capacity = kMinCapacity;
+        while (capacity < n * 2) {
+            capacity *= 2;
+        }
+        if (capacity > this->slots.size()) {
+            this->rehash(capacity);
+        }
+    }
+
+    void Clear() noexcept {
+        this->slots.clear();
+        this->count = 0;
+        this->shift = 64;
+    }
+
+    size_t Size() const noexcept {
+        return this->count;
+    }
+
+private:
+    static constexpr uint32_t kEmpty = kNotFound;
+    static constexpr size_t kMinCapacity = 16;
+
+    struct Slot {
+        Key key;
+        uint32_t value = kEmpty;
+    };
+
+    size_t home(const Key& key) const noexcept {
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> this->shift);
+    }
+
+    size_t next(size_t i) const noexcept {
+        return (i + 1) & (this->slots.size() - 1);
+    }
+
+    void rehash(size_t capacity) {
+        std::pmr::vector<Slot> old(this->slots.get_allocator());
+        old.swap(this->slots);
+        this->slots.assign(capacity, Slot());
+        this->shift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) {
+            this->shift--;
+        }
+        this->count = 0;
+        for (auto& slot : old) {
+            if (slot.value != kEmpty) {
+                this->Assign(slot.key, slot.value);
+            }
+        }
+    }
+
+    std::pmr::vector<Slot> slots;
+    size_t count = 0;
+    unsigned shift = 64;
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef GRAPH_NEIGHBORS_H
+#define GRAPH_NEIGHBORS_H
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include "adjacency.h"
+
+
+/*!
+    \brief Сосед вершины, каким его видит пользователь графа.
+    * vertex - номер соседней вершины
+    * weight - вес ребра к ней
+*/
+template <class VertexId, class Weight>
+struct BasicNeighbor {
+    VertexId vertex;
+    Weight weight;
+};
+
+/*!
+    \brief Сосед вершины невзвешенного графа: только номер вершины
+*/
+template <class VertexId>
+struct BasicNeighbor<VertexId, void> {
+    VertexId vertex;
+};
+
+/*!
+    \brief Класс NeighborRange - диапазон соседей одной вершины без копирования.
+    \details Диапазон смотрит прямо в список смежности графа: итератор идет по хранимым полуребрам и на лету
+    переводит внутренний индекс соседа в его номер через таблицу вершин графа. Ничего не выделяет, подходит
+    для range-for и стандартных алгоритмов (итератор произвольного доступа, разыменование возвращает
+    BasicNeighbor по значению).
+    Порядок соседей не определен. Диапазон действителен, пока граф не изменяется.
+    * first, last - полуребра вершины
+    * ids - таблица перевода внутреннего индекса вершины в ее номер
+*/
+template <class VertexId, class Weight>
+class NeighborRange {
+public:
+    using Neighbor = BasicNeighbor<VertexId, Weight>;
+    using Half = HalfEdge<Weight>;
+
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Neighbor;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Neighbor;
+
+        Iterator() = default;
+        Iterator(const Half* half, const VertexId* ids) : half(half), ids(ids) {}
+
+        Neighbor operator*() const {
+            if constexpr (std::is_void_v<Weight>) {
+                return {this->ids[this->half->to]};
+            } else {
+                return {this->ids[this->half->to], this->half->weight};
+            }
+        }
+        Neighbor operator[](difference_type n) const {
+            return *(*this + n);
+        }
+
+        Iterator& operator++() {
+            ++this->half;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++this->half;
+            return old;
+        }
+        Iterator& operator--() {
+            --this->half;
+            return *this;
+        }
+        Iterator operator--(int) {
+            Iterator old = *this;
+            --this->half;
+            return old;
+        }
+        Iterator& operator+=(difference_type n) {
+            this->half += n;
+            return *this;
+        }
+        Iterator& operator-=(difference_type n) {
+            this->half -= n;
+            return *this;
+        }
+        friend Iterator operator+(Iterator it, difference_type n) {
+            return it += n;
+        }
+        friend Iterator operator+(difference_type n, Iterator it) {
+            return it += n;
+        }
+        friend Iterator operator-(Iterator it, difference_type n) {
+            return it -= n;
+        }
+        friend difference_type operator-(const Iterator& a, const Iterator& b) {
+            return a.half - b.half;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) {
+            return a.half == b.half;
+        }
+        friend bool operator!=(const Iterator& a, const Iterator& b) {
+            return a.half != b.half;
+        }
+        friend bool operator<(const Iterator& a, const Iterator& b) {
+            return a.half < b.half;
+        }
+        friend bool operator>(const Iterator& a, const Iterator& b) {
+            return a.half > b.half;
+        }
+        friend bool operator<=(const Iterator& a, const Iterator& b) {
+            return a.half <= b.half;
+        }
+        friend bool operator>=(const Iterator& a, const Iterator& b) {
+            return a.half >= b.half;
+        }
+
+    private:
+        const Half* half = nullptr;
+        const VertexId* ids = nullptr;
+    };
+
+    NeighborRange(const Half* first, const Half* last, const VertexId* ids) : first(first), last(last), ids(ids) {}
+
+    Iterator begin() const {
+        return Iterator(this->first, this->ids);
+    }
+    Iterator end() const {
+        return Iterator(this->last, this->ids);
+    }
+    size_t size() const {
+        return this->last - this->first;
+    }
+    bool empty() const {
+        return this->first == this->last;
+    }
+    Neighbor operator[](size_t pos) const {
+        return this->begin()[pos];
+    }
+
+private:
+    const Half* first;
+    const Half* last;
+    const VertexId* ids;
+};
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef GRAPH_PARALLEL_H
+#define GRAPH_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+namespace detail {
+
+// меньше этого количества элементов на поток распараллеливать невыгодно
+constexpr size_t kParallelGrain = 1 << 14;
+
+/*!
+ * Количество потоков, на которое стоит делить работу указанного размера
+ * @param work количество элементов
+ * @param grain минимальное количество элементов на поток
+ */
+inline size_t ThreadCount(size_t work, size_t grain = kParallelGrain) {
+    size_t hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+    return std::max<size_t>(1, std::min(hardware, work / std::max<size_t>(1, grain)));
+}
+
+/*!
+ * Делит диапазон [begin, end) на threads непрерывных частей и вызывает f(part, lo, hi) для каждой в своем потоке
+ * @note Исключение, брошенное в любой из частей, пробрасывается вызывающему после завершения всех потоков
+ */
+template <class F>
+void ParallelChunks(size_t begin, size_t end, size_t threads, F&& f) {
+    if (threads <= 1 || end - begin < 2) {
+        if (begin < end) {
+            f(size_t(0), begin, end);
+        }
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    size_t step = (end - begin + threads - 1) / threads;
+    auto run = [&](size_t part) {
+        size_t lo = std::min(end, begin + part * step);
+        size_t hi = std::min(end, lo + step);
+        try {
+            if (lo < hi) {
+                f(part, lo, hi);
+            }
+        } catch (...) {
+            errors[part] = std::current_exception();
+        }
+    };
+    for (size_t part = 1; part < threads; part++) {
+        workers.emplace_back(run, part);
+    }
+    run(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/*!
+ * Параллельно вызывает f(lo, hi) для непрерывных частей диапазона [begin, end)
+ * @param grain минимальное количество элементов на поток
+ */
+template <class F>
+void ParallelFor(size_t begin, size_t end, F&& f, size_t grain = kParallelGrain) {
+    ParallelChunks(begin, end, ThreadCount(end - begin, grain), [&](size_t, size_t lo, size_t hi) {
+        f(lo, hi);
+    });
+}
+
+/*!
+ * Параллельно заменяет каждый элемент суммой предыдущих (исключающая префиксная сумма)
+ * @param values массив, который заменяется префиксными суммами
+ * @param grain минимальное количество элементов на поток
+ * @return Сумма всех элементов
+ * @note Каждая часть сначала считает свою сумму, затем суммы частей складываются последовательно,
+ * и части параллельно расставляют свои префиксные суммы
+ */
+template <class T>
+T ParallelExclusiveScan(std::vector<T>& values, size_t grain = kParallelGrain) {
+    size_t threads = ThreadCount(values.size(), grain);
+    std::vector<T> part_sum(threads + 1, T(0));
+    ParallelChunks(0, values.size(), threads, [&](size_t part, size_t lo, size_t hi) {
+        T sum = T(0);
+        for (size_t i = lo; i < hi; i++) {
+            sum += values[i];
+        }
+        part_sum[part + 1] = sum;
+    });
+    for (size_t part = 0; part < threads; part++) {
+        part_sum[part + 1] += part_sum[part];
+    }
+    ParallelChunks(0, values.size(), threads, [&](size_t part, size_t lo, size_t hi) {
+        T sum = part_sum[part];
+        for (size_t i = lo; i < hi; i++) {
+            T value = values[i];
+            values[i] = sum;
+            sum += value;
+        }
+    });
+    return part_sum[threads];
+}
+
+/*!
+ * Параллельно переставляет элементы [begin, end) так, что сначала идут удовлетворяющие pred, а за ними остальные
+ * @param buffer временный массив, его размер подгоняется под values
+ * @param grain минимальное количество элементов на поток
+ * @return Количество элементов, удовлетворяющих pred
+ * @note pred вызывается ровно один раз для каждого элемента. Каждая часть сначала разбивает свой отрезок на месте,
+ * затем части параллельно переносят свои половины в buffer на места, посчитанные по префиксным суммам,
+ * и buffer копируется обратно. Порядок внутри половин не сохраняется.
+ */
+template <class T, class Pred>
+size_t ParallelPartition(std::vector<T>& values, size_t begin, size_t end, Pred&& pred, std::vector<T>& buffer,
+                         size_t grain = kParallelGrain) {
+    size_t threads = ThreadCount(end - begin, grain);
+    if (threads <= 1) {
+        return std::partition(values.begin() + begin, values.begin() + end, pred) - (values.begin() + begin);
+    }
+
+    std::vector<size_t> passed(threads + 1, 0);
+    ParallelChunks(begin, end, threads, [&](size_t part, size_t lo, size_t hi) {
+        passed[part + 1] = std::partition(values.begin() + lo, values.begin() + hi, pred) - (values.begin() + lo);
+    });
+    for (size_t part = 0; part < threads; part++) {
+        passed[part + 1] += passed[part];
+    }
+    size_t total = passed[threads];
+
+    buffer.resize(values.size());
+    ParallelChunks(begin, end, threads, [&](size_t part, size_t lo, size_t hi) {
+        size_t split = lo + passed[part + 1] - passed[part];
+        // не прошедшие элементы части идут после всех прошедших и после не прошедших элементов предыдущих частей
+        size_t failed_before = (lo - begin) - passed[part];
+        std::copy(values.begin() + lo, values.begin() + split, buffer.begin() + begin + passed[part]);
+        std::copy(values.begin() + split, values.begin() + hi, buffer.begin() + begin + total + failed_before);
+    });
+    ParallelFor(begin, end, [&](size_t lo, size_t hi) {
+        std::copy(buffer.begin() + lo, buffer.begin() + hi, values.begin() + lo);
+    }, grain);
+    return total;
+}
+
+}
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef GRAPH_PROPERTIES_H
+#define GRAPH_PROPERTIES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cow.h"
+#include "hash_index.h"
+
+
+namespace detail {
+template <class T>
+class Column;
+class Properties;
+}
+
+/*!
+    \brief Класс PropertyColumn - столбец свойства вершин или ребер графа.
+    \details Значения лежат в одном непрерывном массиве по слотам: слот вершины - ее место в AllVertex(), слот ребра -
+    его место в таблице ребер графа (см. BasicGraph::EdgeSlot). Размер столбца меняет только граф: при удалении
+    вершины или ребра значение последнего слота переезжает на освободившееся место, как и сама вершина или ребро.
+    Ссылки на значения действительны до следующего изменения множества вершин или ребер графа. Граф выдает столбец
+    для записи только через MutableVertexProperty и MutableEdgeProperty, остальные запросы дают его только для чтения.
+    * values - значения свойства по слотам
+*/
+template <class T>
+class PropertyColumn {
+    static_assert(!std::is_same_v<T, bool>, "std::vector<bool> не хранит значения подряд, для флагов подходит uint8_t");
+
+public:
+    T& operator[](size_t slot) noexcept {
+        return this->values[slot];
+    }
+    const T& operator[](size_t slot) const noexcept {
+        return this->values[slot];
+    }
+    size_t size() const noexcept {
+        return this->values.size();
+    }
+    T* data() noexcept {
+        return this->values.data();
+    }
+    const T* data() const noexcept {
+        return this->values.data();
+    }
+    T* begin() noexcept {
+        return this->values.data();
+    }
+    T* end() noexcept {
+        return this->values.data() + this->values.size();
+    }
+    const T* begin() const noexcept {
+        return this->values.data();
+    }
+    const T* end() const noexcept {
+        return this->values.data() + this->values.size();
+    }
+
+private:
+    friend class detail::Column<T>;
+
+    PropertyColumn(size_t size, std::pmr::memory_resource* resource) : values(size, resource) {}
+    PropertyColumn(const PropertyColumn& other, std::pmr::memory_resource* resource) : values(other.values, resource) {}
+
+    std::pmr::vector<T> values;
+};
+
+
+namespace detail {
+
+// тип, который не выводится из аргумента: тип значения свойства указывается явно, и "text" не превращается в const char*
+template <class T>
+struct NonDeduced {
+    using type = T;
+};
+
+// столбец без типа значений: так граф переставляет значения всех столбцов, не зная их типов
+class ColumnBase {
+public:
+    virtual ~ColumnBase() = default;
+    // добавляет слот со значением по умолчанию
+    virtual void PushBack() = 0;
+    // переносит значение слота from в слот to
+    virtual void Move(size_t from, size_t to) = 0;
+    // оставляет первые size слотов
+    virtual void Truncate(size_t size) = 0;
+    virtual std::shared_ptr<ColumnBase> Clone(std::pmr::memory_resource* resource) const = 0;
+};
+
+template <class T>
+class Column : public ColumnBase {
+public:
+    Column(size_t size, std::pmr::memory_resource* resource) : column(size, resource) {}
+    Column(const Column& other, std::pmr::memory_resource* resource) : column(other.column, resource) {}
+
+    void PushBack() override {
+        this->column.values.emplace_back();
+    }
+    void Move(size_t from, size_t to) override {
+        this->column.values[to] = std::move(this->column.values[from]);
+    }
+    void Truncate(size_t size) override {
+        this->column.values.erase(this->column.values.begin() + size, this->column.values.end());
+    }
+    std::shared_ptr<ColumnBase> Clone(std::pmr::memory_resource* resource) const override {
+        return MakeShared<Column>(resource, *this, resource);
+    }
+
+    PropertyColumn<T> column;
+};
+
+/*!
+    \brief Класс Properties - столбцы свойств вершин и ребер графа и таблица слотов ребер.
+    \details Вершина уже имеет плотный слот - свой внутренний индекс, а у ребра своего места в графе нет (полуребра
+    лежат в списках смежности двух вершин), поэтому, пока есть хотя бы один столбец ребер, граф ведет таблицу слотов
+    ребер: ключ ребра - пара внутренних индексов его концов (меньший в старших 32 битах). Удаление ребра переносит
+    последний слот на место удаленного, поэтому слоты ребер всегда заняты подряд.
+    * vertex_columns - столбцы свойств вершин по именам
+    * edge_columns - столбцы свойств ребер по именам
+    * edge_keys - ключ ребра в каждом слоте
+    * edge_slots - хеш-индекс ключ ребра -> слот
+*/
+class Properties {
+public:
+    explicit Properties(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : vertex_columns(resource), edge_columns(resource), edge_keys(resource), edge_slots(resource) {}
+    Properties(const Properties& other, std::pmr::memory_resource* resource)
+        : vertex_columns(resource), edge_columns(resource), edge_keys(other.edge_keys, resource),
+          edge_slots(other.edge_slots, resource) {
+        for (auto& [name, column] : other.vertex_columns) {
+            this->vertex_columns.emplace(name, column->Clone(resource));
+        }
+        for (auto& [name, column] : other.edge_columns) {
+            this->edge_columns.emplace(name, column->Clone(resource));
+        }
+    }
+
+    static uint64_t EdgeKey(uint32_t u, uint32_t v) noexcept {
+        return (uint64_t(std::min(u, v)) << 32) | std::max(u, v);
+    }
+
+    bool Empty() const noexcept {
+        return this->vertex_columns.empty() && this->edge_columns.empty();
+    }
+    bool HasEdgeColumns() const noexcept {
+        return !this->edge_columns.empty();
+    }
+
+    /*!
+     * Столбец по имени
+     * @param edge столбец ребер или вершин
+     * @return Столбец или nullptr, если столбца нет или у него другой тип значений
+     */
+    template <class T>
+    Column<T>* Find(bool edge, std::string_view name) const {
+        const Map& columns = edge ? this->edge_columns : this->vertex_columns;
+        auto it = columns.find(name);
+        return it == columns.end() ? nullptr : dynamic_cast<Column<T>*>(it->second.get());
+    }
+    // есть ли столбец с таким именем, все равно какого типа
+    bool Contains(bool edge, std::string_view name) const {
+        const Map& columns = edge ? this->edge_columns : this->vertex_columns;
+        return columns.find(name) != columns.end();
+    }
+    template <class T>
+    Column<T>& Add(bool edge, std::string_view name, size_t size) {
+        Map& columns = edge ? this->edge_columns : this->vertex_columns;
+        std::shared_ptr<Column<T>> column = MakeShared<Column<T>>(this->Resource(), size, this->Resource());
+        columns.emplace(name, column);
+        return *column;
+    }
+    bool Remove(bool edge, std::string_view name) {
+        Map& columns = edge ? this->edge_columns : this->vertex_columns;
+        auto it = columns.find(name);
+        if (it == columns.end()) {
+            return false;
+        }
+        columns.erase(it);
+        if (edge && columns.empty()) {
+            // без столбцов ребер таблица слотов не нужна
+            this->edge_keys.clear();
+            this->edge_slots.Clear();
+        }
+        return true;
+    }
+
+    // слоты вершин
+    void PushVertex() {
+        for (auto& [name, column] : this->vertex_columns) {
+            column->PushBack();
+        }
+    }
+    void MoveVertex(size_t from, size_t to) {
+        for (auto& [name, column] : this->vertex_columns) {
+            column->Move(from, to);
+        }
+    }
+    void TruncateVertices(size_t size) {
+        for (auto& [name, column] : this->vertex_columns) {
+            column->Truncate(size);
+        }
+    }
+
+    // слоты ребер
+    size_t EdgeCount() const noexcept {
+        return this->edge_keys.size();
+    }
+    uint32_t FindEdge(uint32_t u, uint32_t v) const noexcept {
+        return this->edge_slots.Find(EdgeKey(u, v));
+    }
+    uint64_t KeyAt(size_t slot) const noexcept {
+        return this->edge_keys[slot];
+    }
+    void PushEdge(uint32_t u, uint32_t v) {
+        this->edge_slots.Assign(EdgeKey(u, v), this->edge_keys.size());
+        this->edge_keys.push_back(EdgeKey(u, v));
+        for (auto& [name, column] : this->edge_columns) {
+            column->PushBack();
+        }
+    }
+    // удаляет ребро, если оно есть в таблице; последний слот переезжает на место удаленного
+    void EraseEdge(uint32_t u, uint32_t v) {
+        uint64_t key = EdgeKey(u, v);
+        uint32_t slot = this->edge_slots.Find(key);
+        if (slot == HashIndex<uint64_t>::kNotFound) {
+            return;
+        }
+        this->edge_slots.Erase(key);
+        size_t last = this->edge_keys.size() - 1;
+        if (slot != last) {
+            this->edge_keys[slot] = this->edge_keys[last];
+            this->edge_slots.Assign(this->edge_keys[slot], slot);
+            for (auto& [name, column] : this->edge_columns) {
+                column->Move(last, slot);
+            }
+        }
+        this->edge_keys.pop_back();
+        for (auto& [name, column] : this->edge_columns) {
+            column->Truncate(last);
+        }
+    }
+    // меняет ключ ребра, когда его конец переезжает на другой внутренний индекс; слот и значения остаются на месте
+    void RekeyEdge(uint64_t old_key, uint64_t new_key) {
+        uint32_t slot = this->edge_slots.Find(old_key);
+        this->edge_slots.Erase(old_key);
+        this->edge_slots.Assign(new_key, slot);
+        this->edge_keys[slot] = new_key;
+    }
+
+    std::pmr::memory_resource* Resource() const noexcept {
+        return this->edge_keys.get_allocator().resource();
+    }
+
+private:
+    using Map = std::pmr::map<std::pmr::string, std::shared_ptr<ColumnBase>, std::less<>>;
+
+    Map vertex_columns;
+    Map edge_columns;
+    std::pmr::vector<uint64_t> edge_keys;
+    HashIndex<uint64_t> edge_slots;
+};
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef GRAPH_RADIX_SORT_H
+#define GRAPH_RADIX_SORT_H
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "parallel.h"
+
+
+namespace detail {
+
+/*!
+ * Устойчивая поразрядная (LSD) сортировка беззнаковых ключей по битам [low_bit, high_bit)
+ * @param keys массив ключей
+ * @param low_bit младший бит, с которого начинается сравнение; более младшие биты не сортируются и сохраняют исходный порядок
+ * @param high_bit бит, на котором сравнение заканчивается
+ * @note Каждый проход делает параллельную гистограмму и параллельную раскладку по частям массива.
+ * Проход пропускается, если у всех ключей совпадает текущий разряд.
+ */
+template <class T>
+void RadixSort(std::vector<T>& keys, unsigned low_bit = 0, unsigned high_bit = sizeof(T) * 8) {
+    static_assert(std::is_unsigned_v<T>, "RadixSort сортирует только беззнаковые ключи");
+    constexpr unsigned kDigitBits = 8;
+    constexpr size_t kBuckets = size_t(1) << kDigitBits;
+
+    size_t n = keys.size();
+    if (n < 2) {
+        return;
+    }
+    std::vector<T> buffer(n);
+    size_t threads = ThreadCount(n);
+    std::vector<size_t> count(threads * kBuckets);
+
+    for (unsigned shift = low_bit; shift < high_bit; shift += kDigitBits) {
+        unsigned width = std::min(kDigitBits, high_bit - shift);
+        T mask = static_cast<T>((T(1) << width) - 1);
+
+        std::fill(count.begin(), count.end(), 0);
+        ParallelChunks(0, n, threads, [&](size_t part, size_t lo, size_t hi) {
+            size_t* local = count.data() + part * kBuckets;
+            for (size_t i = lo; i < hi; i++) {
+                local[(keys[i] >> shift) & mask]++;
+            }
+        });
+
+        // если все ключи попали в одну корзину, проход ничего не меняет
+        bool trivial = false;
+        for (size_t d = 0; d < kBuckets && !trivial; d++) {
+            size_t total = 0;
+            for (size_t p = 0; p < threads; p++) {
+                total += count[p * kBuckets + d];
+            }
+            trivial = total == n;
+        }
+        if (trivial) {
+            continue;
+        }
+
+        // начало каждой корзины каждой части: сначала по разряду, потом по номеру части, чтобы сортировка была устойчивой
+        size_t sum = 0;
+        for (size_t d = 0; d < kBuckets; d++) {
+            for (size_t p = 0; p < threads; p++) {
+                size_t c = count[p * kBuckets + d];
+                count[p * kBuckets + d] = sum;
+                sum += c;
+            }
+        }
+
+        ParallelChunks(0, n, threads, [&](size_t part, size_t lo, size_t hi) {
+            size_t* local = count.data() + part * kBuckets;
+            for (size_t i = lo; i < hi; i++) {
+                buffer[local[(keys[i] >> shift) & mask]++] = keys[i];
+            }
+        });
+        keys.swap(buffer);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef GRAPH_SMALL_VECTOR_H
+#define GRAPH_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+
+namespace detail {
+
+/*!
+    \brief Класс SmallVector - динамический массив, первые N элементов которого хранятся прямо в объекте.
+    \details Пока элементов не больше N, массив не обращается к куче вовсе; при переполнении элементы переезжают
+    в выделенный блок, который дальше растет удвоением. Обратно во встроенный буфер массив не возвращается,
+    пока не вызван ShrinkToFit.
+    Поддерживаются только тривиально копируемые элементы: это позволяет переносить их memcpy и не вызывать
+    конструкторы и деструкторы.
+    Блоки в куче берутся из memory_resource по правилам std::pmr: копия получает ресурс по умолчанию, перемещение
+    забирает ресурс вместе с блоком, а присваивание сохраняет ресурс того объекта, которому присваивают.
+    * heap - блок в куче, когда элементов больше N
+    * buffer - встроенный буфер
+    * count - количество элементов
+    * capacity - вместимость; равна N, пока используется встроенный буфер
+    * resource - откуда берутся блоки в куче
+*/
+template <class T, uint32_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector хранит только тривиально копируемые элементы");
+    static_assert(N > 0, "встроенный буфер не может быть пустым");
+
+public:
+    SmallVector() noexcept = default;
+    explicit SmallVector(std::pmr::memory_resource* resource) noexcept : resource(resource) {}
+    SmallVector(const SmallVector& other, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : resource(resource) {
+        this->assign(other);
+    }
+    SmallVector(SmallVector&& other) noexcept : resource(other.resource) {
+        this->steal(other);
+    }
+    SmallVector(SmallVector&& other, std::pmr::memory_resource* resource) : resource(resource) {
+        this->moveFrom(other);
+    }
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            this->assign(other);
+        }
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other) {
+        if (this != &other) {
+            this->moveFrom(other);
+        }
+        return *this;
+    }
+    ~SmallVector() {
+        this->release();
+    }
+
+    std::pmr::memory_resource* Resource() const noexcept {
+        return this->resource;
+    }
+    bool IsInline() const noexcept {
+        return this->capacity == N;
+    }
+    size_t size() const noexcept {
+        return this->count;
+    }
+    size_t Capacity() const noexcept {
+        return this->capacity;
+    }
+    bool empty() const noexcept {
+        return this->count == 0;
+    }
+    T* data() noexcept {
+        return this->IsInline() ? this->buffer : this->heap;
+    }
+    const T* data() const noexcept {
+        return this->IsInline() ? this->buffer : this->heap;
+    }
+    T* begin() noexcept {
+        return this->data();
+    }
+    T* end() noexcept {
+        return this->data() + this->count;
+    }
+    const T* begin() const noexcept {
+        return this->data();
+    }
+    const T* end() const noexcept {
+        return this->data() + this->count;
+    }
+    T& operator[](size_t pos) noexcept {
+        return this->data()[pos];
+    }
+    const T& operator[](size_t pos) const noexcept {
+        return this->data()[pos];
+    }
+    T& back() noexcept {
+        return this->data()[this->count - 1];
+    }
+
+    void Reserve(size_t n) {
+        if (n > this->capacity) {
+            this->grow(n);
+        }
+    }
+
+    void push_back(const T& value) {
+        if (this->count == this->capacity) {
+            this->grow(size_t(this->capacity) * 2);
+        }
+        this->data()[this->count++] = value;
+    }
+
+    void pop_back() noexcept {
+        this->count--;
+    }
+
+    T* insert(T* pos, const T& value) {
+        size_t ind = pos - this->data();
+        if (this->count == this->capacity) {
+            this->grow(size_t(this->capacity) * 2);
+        }
+        T* place = this->data() + ind;
+        std::memmove(place + 1, place, (this->count - ind) * sizeof(T));
+        *place = value;
+        this->count++;
+        return place;
+    }
+
+    T* erase(T* pos) noexcept {
+        return this->erase(pos, pos + 1);
+    }
+
+    T* erase(T* first, T* last) noexcept {
+        std::memmove(first, last, (this->end() - last) * sizeof(T));
+        this->count -= last - first;
+        return first;
+    }
+
+    void clear() noexcept {
+        this->count = 0;
+    }
+
+    /*!
+     * Возвращает элементы во встроенный буфер, если они туда помещаются, иначе ужимает блок до размера массива
+     */
+    void ShrinkToFit() {
+        if (this->IsInline() || this->count == this->capacity) {
+            return;
+        }
+        T* old = this->heap;
+        size_t old_capacity = this->capacity;
+        if (this->count <= N) {
+            std::memcpy(this->buffer, old, this->count * sizeof(T));
+            this->capacity = N;
+        } else {
+            this->heap = this->allocate(this->count);
+            std::memcpy(this->heap, old, this->count * sizeof(T));
+            this->capacity = this->count;
+        }
+        this->deallocate(old, old_capacity);
+    }
+
+private:
+    T* allocate(size_t n) {
+        if (n > UINT32_MAX) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(this->resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* block, size_t n) noexcept {
+        this->resource->deallocate(block, n * sizeof(T), alignof(T));
+    }
+
+    void grow(size_t new_capacity) {
+        T* block = this->allocate(new_capacity);
+        std::memcpy(block, this->data(), this->count * sizeof(T));
+        this->release();
+        this->heap = block;
+        this->capacity = new_capacity;
+    }
+
+    void release() noexcept {
+        if (!this->IsInline()) {
+            this->deallocate(this->heap, this->capacity);
+            this->capacity = N;
+        }
+    }
+
+    void assign(const SmallVector& other) {
+        this->count = 0;
+        this->Reserve(other.count);
+        std::memcpy(this->data(), other.data(), other.count * sizeof(T));
+        this->count = other.count;
+    }
+
+    // блок можно забрать, только если он выделен из того же ресурса, иначе элементы копируются
+    void moveFrom(SmallVector& other) {
+        if (other.IsInline() || !this->resource->is_equal(*other.resource)) {
+            this->assign(other);
+            other.count = 0;
+            return;
+        }
+        this->release();
+        this->steal(other);
+    }
+
+    void steal(SmallVector& other) noexcept {
+        if (other.IsInline()) {
+            std::memcpy(this->buffer, other.buffer, other.count * sizeof(T));
+        } else {
+            this->heap = other.heap;
+            this->capacity = other.capacity;
+            other.capacity = N;
+        }
+        this->count = other.count;
+        other.count = 0;
+    }
+
+    union {
+        T* heap;
+        T buffer[N];
+    };
+    uint32_t count = 0;
+    uint32_t capacity = N;
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+};
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+#include "graph.h"
+
+#include "arena.h"
+#include "parallel.h"
+
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::InducedSubgraph(const std::vector<VertexId>& vertices, SubgraphIds ids,
+                                                                           std::pmr::memory_resource* resource) const {
+    std::vector<uint32_t> keep(this->vertex->size(), 0);
+    for (auto& v_num : vertices) {
+        int ind = this->findVertex(v_num);
+        if (ind == -1) {
+            throw Exceptions("Вершина нет в графе\n");
+        }
+        keep[ind] = 1;
+    }
+    return this->extract(keep, [](const Edge&) {
+        return true;
+    }, ids, resource);
+}
+
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::FilterEdges(const std::function<bool(const Edge&)>& pred, SubgraphIds ids,
+                                                                       std::pmr::memory_resource* resource) const {
+    std::vector<uint32_t> keep(this->vertex->size(), 1);
+    return this->extract(keep, std::cref(pred), ids, resource);
+}
+
+template <class VertexId, class Weight>
+template <class Pred>
+BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::extract(const std::vector<uint32_t>& keep, Pred pred, SubgraphIds ids,
+                                                                   std::pmr::memory_resource* resource) const {
+    size_t n = this->vertex->size();
+    const std::pmr::vector<VertexId>& source_ids = *this->vertex;
+
+    // 1. место оставленной вершины в подграфе - количество оставленных вершин перед ней; такая нумерация
+    // сохраняет порядок вершин, поэтому упорядоченные списки смежности остаются упорядоченными
+    std::vector<uint32_t> place = keep;
+    size_t k = detail::ParallelExclusiveScan(place);
+
+    BasicGraph result(resource);
+    result.hub_threshold = this->hub_threshold;
+    std::pmr::vector<VertexId>& result_ids = result.vertex.Mutable();
+    result_ids.resize(k);
+    detail::ParallelFor(0, n, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            if (keep[i]) {
+                result_ids[place[i]] = ids == SubgraphIds::Keep ? source_ids[i] : static_cast<VertexId>(place[i]);
+            }
+        }
+    });
+    HashIndex<VertexId>& index = result.vertex_index.Mutable();
+    index.Reserve(k);
+    for (size_t j = 0; j < k; j++) {
+        index.Assign(result_ids[j], j);
+    }
+    result.edge.resize(k);
+
+    // 2. каждый список смежности подграфа пишет один поток: сначала отбирает полуребра во временный буфер,
+    // чтобы вызвать pred один раз на полуребро, затем резервирует список точно под их количество
+    detail::ParallelFor(0, n, [&](size_t lo, size_t hi) {
+        std::vector<Half> passed;
+        for (size_t i = lo; i < hi; i++) {
+            if (!keep[i]) {
+                continue;
+            }
+            passed.clear();
+            for (auto& half : this->edge[i]) {
+                if (!keep[half.to]) {
+                    continue;
+                }
+                VertexId from_v = source_ids[i];
+                VertexId to_v = source_ids[half.to];
+                if (pred(makeEdge(std::min(from_v, to_v), std::max(from_v, to_v), half))) {
+                    passed.push_back(half);
+                    passed.back().to = place[half.to];
+                }
+            }
+
+            List& list = result.edge.Mutable(place[i]);
+            list.Reserve(passed.size());
+            for (auto& half : passed) {
+                list.PushBackUnordered(half);
+            }
+            // список хаба не упорядочен, его нужно отсортировать; обычный список уже упорядочен
+            list.Normalize(this->edge[i].IsHub() ? 0 : list.size(), result.hub_threshold);
+        }
+    }, result.listGrain(1024));
+
+    return result;
+}
+
+#define INSTANTIATE(VertexId, Weight) \
+    template BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::InducedSubgraph(const std::vector<VertexId>&, SubgraphIds, \
+                                                                                        std::pmr::memory_resource*) const; \
+    template BasicGraph<VertexId, Weight> BasicGraph<VertexId, Weight>::FilterEdges(const std::function<bool(const Edge&)>&, \
+                                                                                    SubgraphIds, std::pmr::memory_resource*) const;
+GRAPH_FOR_EACH_INSTANCE(INSTANTIATE)
+#undef INSTANTIATE
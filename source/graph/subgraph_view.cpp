@@ -0,0 +1,264 @@
+#include "subgraph_view.h"
+
+#include <algorithm>
+#include <type_traits>
+
+template <class Graph>
+SubgraphView<Graph>::SubgraphView(const Graph& graph) : graph(&graph), vertex_count(vertexCount()) {
+    if constexpr (!std::is_same_v<Graph, ResultGraph>) {
+        this->frozen_index.Reserve(this->vertex_count);
+        for (size_t i = 0; i < this->vertex_count; i++) {
+            this->frozen_index.Assign(this->id(i), i);
+        }
+    }
+}
+
+template <class Graph>
+SubgraphView<Graph>& SubgraphView<Graph>::KeepVertices(const std::vector<VertexId>& vertices) {
+    std::vector<VertexId> sorted = vertices;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    // каждая перечисленная вершина должна найтись в графе, даже если она уже отфильтрована раньше
+    size_t n = this->vertexCount();
+    if (this->vertex_mask.empty()) {
+        this->vertex_mask.assign(n, true);
+    }
+    size_t found = 0;
+    this->vertex_count = 0;
+    for (size_t i = 0; i < n; i++) {
+        bool listed = std::binary_search(sorted.begin(), sorted.end(), this->id(i));
+        found += listed;
+        this->vertex_mask[i] = this->vertex_mask[i] && listed;
+        this->vertex_count += this->vertex_mask[i];
+    }
+    if (found != sorted.size()) {
+        throw typename ResultGraph::Exceptions("Вершина нет в графе\n");
+    }
+    return *this;
+}
+
+template <class Graph>
+SubgraphView<Graph>& SubgraphView<Graph>::FilterVertices(const VertexFilter& pred) {
+    size_t n = this->vertexCount();
+    if (this->vertex_mask.empty()) {
+        this->vertex_mask.assign(n, true);
+    }
+    this->vertex_count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (this->vertex_mask[i]) {
+            this->vertex_mask[i] = pred(this->id(i));
+            this->vertex_count += this->vertex_mask[i];
+        }
+    }
+    return *this;
+}
+
+template <class Graph>
+SubgraphView<Graph>& SubgraphView<Graph>::FilterEdges(EdgeFilter pred) {
+    if (!this->edge_filter) {
+        this->edge_filter = std::move(pred);
+    } else {
+        this->edge_filter = [first = std::move(this->edge_filter), second = std::move(pred)](const Edge& e) {
+            return first(e) && second(e);
+        };
+    }
+    return *this;
+}
+
+template <class Graph>
+int SubgraphView<Graph>::Size() const noexcept {
+    return this->vertex_count;
+}
+
+template <class Graph>
+std::vector<typename SubgraphView<Graph>::VertexId> SubgraphView<Graph>::AllVertex() const {
+    std::vector<VertexId> vertices;
+    vertices.reserve(this->vertex_count);
+    for (size_t i = 0; i < this->vertexCount(); i++) {
+        if (this->keeps(i)) {
+            vertices.push_back(this->id(i));
+        }
+    }
+    return vertices;
+}
+
+template <class Graph>
+std::vector<typename SubgraphView<Graph>::Edge> SubgraphView<Graph>::AllEdges() const {
+    std::vector<Edge> allEdges;
+    for (size_t i = 0; i < this->vertexCount(); i++) {
+        if (!this->keeps(i)) {
+            continue;
+        }
+        // ребро выдается у меньшей вершины, петли пропускаются, как в BasicGraph::AllEdges
+        this->forEachHalf(i, [&](uint32_t to, const Edge& e) {
+            if (this->id(i) < this->id(to)) {
+                allEdges.push_back(e);
+            }
+        });
+    }
+    return allEdges;
+}
+
+template <class Graph>
+std::vector<typename SubgraphView<Graph>::Edge> SubgraphView<Graph>::Edges() const {
+    std::vector<Edge> edges;
+    for (size_t i = 0; i < this->vertexCount(); i++) {
+        if (!this->keeps(i)) {
+            continue;
+        }
+        // ребро выдается у меньшей вершины, петля - у своей единственной
+        this->forEachHalf(i, [&](uint32_t to, const Edge& e) {
+            if (!(this->id(to) < this->id(i))) {
+                edges.push_back(e);
+            }
+        });
+    }
+    return edges;
+}
+
+template <class Graph>
+std::vector<typename SubgraphView<Graph>::Neighbor> SubgraphView<Graph>::Neighbors(const VertexId& v_num) const {
+    uint32_t ind = this->find(v_num);
+    if (ind == HashIndex<VertexId>::kNotFound) {
+        throw typename ResultGraph::Exceptions("Вершина нет в графе\n");
+    }
+    std::vector<Neighbor> neighbors;
+    this->forEachHalf(ind, [&](uint32_t to, const Edge& e) {
+        if constexpr (std::is_void_v<Weight>) {
+            neighbors.push_back({this->id(to)});
+        } else {
+            neighbors.push_back({this->id(to), e.weight});
+        }
+    });
+    return neighbors;
+}
+
+template <class Graph>
+size_t SubgraphView<Graph>::Degree(const VertexId& v_num) const {
+    uint32_t ind = this->find(v_num);
+    if (ind == HashIndex<VertexId>::kNotFound) {
+        throw typename ResultGraph::Exceptions("Вершина нет в графе\n");
+    }
+    size_t degree = 0;
+    this->forEachHalf(ind, [&](uint32_t, const Edge&) {
+        degree++;
+    });
+    return degree;
+}
+
+template <class Graph>
+bool SubgraphView<Graph>::HasVertex(const VertexId& v_num) const noexcept {
+    return this->find(v_num) != HashIndex<VertexId>::kNotFound;
+}
+
+template <class Graph>
+bool SubgraphView<Graph>::HasEdge(const VertexId& from_v, const VertexId& to_v) const {
+    return this->findEdge(from_v, to_v).has_value();
+}
+
+template <class Graph>
+typename SubgraphView<Graph>::FrozenGraph SubgraphView<Graph>::Freeze() const {
+    size_t n = this->vertexCount();
+    FrozenGraph frozen;
+
+    // оставленные вершины получают в снимке индексы подряд
+    std::vector<uint32_t> remap(n, HashIndex<VertexId>::kNotFound);
+    frozen.vertex.reserve(this->vertex_count);
+    for (size_t i = 0; i < n; i++) {
+        if (this->keeps(i)) {
+            remap[i] = frozen.vertex.size();
+            frozen.vertex.push_back(this->id(i));
+        }
+    }
+
+    frozen.offset.assign(frozen.vertex.size() + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+        if (this->keeps(i)) {
+            this->forEachHalf(i, [&](uint32_t, const Edge&) {
+                frozen.offset[remap[i] + 1]++;
+            });
+        }
+    }
+    for (size_t i = 0; i < frozen.vertex.size(); i++) {
+        frozen.offset[i + 1] += frozen.offset[i];
+    }
+
+    frozen.neighbor.resize(frozen.offset.back());
+    if constexpr (!std::is_void_v<Weight>) {
+        frozen.weight.resize(frozen.offset.back());
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (!this->keeps(i)) {
+            continue;
+        }
+        size_t k = frozen.offset[remap[i]];
+        this->forEachHalf(i, [&](uint32_t to, const Edge& e) {
+            frozen.neighbor[k] = remap[to];
+            if constexpr (!std::is_void_v<Weight>) {
+                frozen.weight[k] = e.weight;
+            }
+            k++;
+        });
+    }
+
+    return frozen;
+}
+
+template <class Graph>
+uint32_t SubgraphView<Graph>::find(const VertexId& v_num) const noexcept {
+    uint32_t ind;
+    if constexpr (std::is_same_v<Graph, ResultGraph>) {
+        int found = this->graph->findVertex(v_num);
+        ind = found == -1 ? HashIndex<VertexId>::kNotFound : found;
+    } else {
+        ind = this->frozen_index.Find(v_num);
+    }
+    return ind != HashIndex<VertexId>::kNotFound && this->keeps(ind) ? ind : HashIndex<VertexId>::kNotFound;
+}
+
+template <class Graph>
+std::optional<typename SubgraphView<Graph>::Edge> SubgraphView<Graph>::findEdge(const VertexId& from_v, const VertexId& to_v) const {
+    uint32_t from = this->find(from_v);
+    uint32_t to = this->find(to_v);
+    if (from == HashIndex<VertexId>::kNotFound || to == HashIndex<VertexId>::kNotFound) {
+        return std::nullopt;
+    }
+
+    // ребро ищется в исходном графе, а фильтр ребер проверяется только для найденного ребра
+    std::optional<Edge> found;
+    auto make = [&](const auto&... weight) {
+        found.emplace(std::min(from_v, to_v), std::max(from_v, to_v), weight...);
+    };
+    if constexpr (std::is_same_v<Graph, ResultGraph>) {
+        int pos = this->graph->findEdge(from, to);
+        if (pos != -1) {
+            if constexpr (std::is_void_v<Weight>) {
+                make();
+            } else {
+                make(this->graph->edge[from][pos].weight);
+            }
+        }
+    } else {
+        for (size_t k = this->graph->offset[from]; k < this->graph->offset[from + 1]; k++) {
+            if (this->graph->neighbor[k] == to) {
+                if constexpr (std::is_void_v<Weight>) {
+                    make();
+                } else {
+                    make(this->graph->weight[k]);
+                }
+                break;
+            }
+        }
+    }
+    if (found && this->edge_filter && !this->edge_filter(*found)) {
+        found.reset();
+    }
+    return found;
+}
+
+#define INSTANTIATE(VertexId, Weight) \
+    template class SubgraphView<BasicGraph<VertexId, Weight>>; \
+    template class SubgraphView<BasicFrozenGraph<VertexId, Weight>>;
+GRAPH_FOR_EACH_INSTANCE(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,247 @@
+#ifndef GRAPH_SUBGRAPH_VIEW_H
+#define GRAPH_SUBGRAPH_VIEW_H
+
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "frozen_graph.h"
+#include "graph.h"
+
+
+namespace detail {
+
+// типы вершин и весов графа, над которым построено представление
+template <class Graph>
+struct GraphTypes;
+
+template <class VertexId, class Weight>
+struct GraphTypes<BasicGraph<VertexId, Weight>> {
+    using Vertex = VertexId;
+    using EdgeWeight = Weight;
+};
+
+template <class VertexId, class Weight>
+struct GraphTypes<BasicFrozenGraph<VertexId, Weight>> {
+    using Vertex = VertexId;
+    using EdgeWeight = Weight;
+};
+
+}
+
+/*!
+    \brief Класс SubgraphView - подграф, который не копирует исходный граф, а фильтрует его на лету.
+    \details Представление строится над BasicGraph или BasicFrozenGraph и оставляет от него вершины, прошедшие
+    фильтр вершин, и ребра между ними, прошедшие фильтр ребер. Для вершин хранится битовая маска (один бит на
+    вершину), фильтр ребер - это предикат, который вычисляется при обходе и памяти под ребра не требует.
+    Представление отвечает на те же вопросы, что и граф (Size, AllVertex, AllEdges, Edges, Neighbors, Degree,
+    HasVertex, HasEdge, GetWeight, FindMST, Freeze), применяя фильтры на лету, поэтому алгоритмы запускаются на нем
+    так же, как на целом графе, без построения нового графа ребро за ребром. Снимку, в отличие от BasicGraph, нечем
+    искать вершину по номеру, поэтому представление над снимком строит хеш-индекс вершин за O(V) при создании.
+    Представление действительно, пока исходный граф жив и не изменяется.
+    * graph - исходный граф
+    * vertex_mask - оставленные вершины по внутренним индексам графа; пустая маска оставляет все вершины
+    * vertex_count - количество оставленных вершин
+    * edge_filter - предикат ребер; пустой оставляет все ребра между оставленными вершинами
+    * frozen_index - номер вершины -> индекс в снимке; у представления над BasicGraph пуст
+*/
+template <class Graph>
+class SubgraphView {
+public:
+    using VertexId = typename detail::GraphTypes<Graph>::Vertex;
+    using Weight = typename detail::GraphTypes<Graph>::EdgeWeight;
+    using Edge = BasicEdge<VertexId, Weight>;
+    using Neighbor = BasicNeighbor<VertexId, Weight>;
+    using FrozenGraph = BasicFrozenGraph<VertexId, Weight>;
+    using ResultGraph = BasicGraph<VertexId, Weight>;
+    using VertexFilter = std::function<bool(const VertexId&)>;
+    using EdgeFilter = std::function<bool(const Edge&)>;
+
+    /*!
+     * Создает представление, в котором оставлен весь граф
+     * @param graph исходный граф; должен жить дольше представления и не меняться
+     */
+    explicit SubgraphView(const Graph& graph);
+
+    /*!
+     * Оставляет из уже оставленных вершин только перечисленные
+     * @param vertices номера вершин
+     * @throw std::exception Если какой-то вершины нет в графе
+     */
+    SubgraphView& KeepVertices(const std::vector<VertexId>& vertices);
+    /*!
+     * Оставляет из уже оставленных вершин только те, для которых pred вернул true; pred вызывается один раз на вершину
+     * @param pred предикат номера вершины
+     */
+    SubgraphView& FilterVertices(const VertexFilter& pred);
+    /*!
+     * Оставляет из уже оставленных ребер только те, для которых pred вернул true
+     * @param pred предикат ребра; получает ребро с from_vertex <= other_vertex и должен давать один и тот же
+     * ответ для одного и того же ребра, так как вычисляется при каждом обходе
+     */
+    SubgraphView& FilterEdges(EdgeFilter pred);
+
+    /*!
+     * Функция определения размера подграфа
+     * @return Количество оставленных вершин
+     */
+    int Size() const noexcept;
+    /*!
+     * Функция, показывающая вершины подграфа
+     * @return Список оставленных вершин в порядке хранения исходного графа
+     */
+    std::vector<VertexId> AllVertex() const;
+    /*!
+     * Функция, показывающая ребра подграфа
+     * @return Список оставленных ребер без петель, меньшая вершина ребра идет первой
+     */
+    std::vector<Edge> AllEdges() const;
+    /*!
+     * Функция, показывающая ребра подграфа вместе с петлями, как BasicGraph::Edges
+     * @return Каждое оставленное ребро и петля один раз, меньшая вершина ребра идет первой
+     */
+    std::vector<Edge> Edges() const;
+    /*!
+     * Функция, показывающая соседей вершины подграфа; фильтры применяются при обходе ее списка смежности
+     * @param v_num номер вершины
+     * @return Соседи по оставленным ребрам за O(d), петля дает вершине саму себя один раз
+     * @throw std::exception Если вершины нет в подграфе
+     */
+    std::vector<Neighbor> Neighbors(const VertexId& v_num) const;
+    /*!
+     * Функция определения степени вершины подграфа за O(d)
+     * @param v_num номер вершины
+     * @return Количество соседей вершины, то есть размер Neighbors(v_num)
+     * @throw std::exception Если вершины нет в подграфе
+     */
+    size_t Degree(const VertexId& v_num) const;
+    /*!
+     * Функция проверки вершины за O(1) в среднем
+     * @param v_num номер вершины
+     * @return Есть ли вершина в исходном графе и прошла ли она фильтры вершин
+     */
+    bool HasVertex(const VertexId& v_num) const noexcept;
+    /*!
+     * Функция проверки ребра: поиск ребра в исходном графе и фильтр ребер; у снимка ребро ищется в списке
+     * смежности за O(d)
+     * @param from_v одна из вершин ребра
+     * @param to_v другая вершина ребра
+     * @return Есть ли ребро в подграфе; если какой-то вершины в подграфе нет, то ребра тоже нет
+     */
+    bool HasEdge(const VertexId& from_v, const VertexId& to_v) const;
+    /*!
+     * Функция, показывающая вес ребра подграфа, с той же сложностью, что HasEdge
+     * @param from_v одна из вершин ребра
+     * @param to_v другая вершина ребра
+     * @return Вес ребра
+     * @throw std::exception Если ребра нет в подграфе
+     * @note Есть только у взвешенного графа
+     */
+    template <class W = Weight, std::enable_if_t<!std::is_void_v<W>, int> = 0>
+    W GetWeight(const VertexId& from_v, const VertexId& to_v) const {
+        std::optional<Edge> e = this->findEdge(from_v, to_v);
+        if (!e) {
+            throw typename ResultGraph::Exceptions("Ребра нет в графе\n");
+        }
+        return e->weight;
+    }
+    /*!
+     * Строит неизменяемый снимок подграфа в формате CSR за O(V+E) исходного графа
+     * @return Объект класса BasicFrozenGraph с оставленными вершинами и ребрами
+     */
+    FrozenGraph Freeze() const;
+    /*!
+     * Функция поиска минимального остовного дерева подграфа, то же, что FindMST(MstAlgorithm::Auto, resource)
+     * @param resource источник памяти для результата
+     * @return Минимальное остовное дерево подграфа
+     * @throw std::exception Если подграф несвязный
+     */
+    ResultGraph FindMST(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    /*!
+     * Функция поиска минимального остовного дерева подграфа указанным алгоритмом
+     * @param algorithm алгоритм; MstAlgorithm::Auto выбирает его так же, как у BasicFrozenGraph
+     * @param resource источник памяти для результата
+     * @return Минимальное остовное дерево подграфа
+     * @throw std::exception Если подграф несвязный
+     * @note Прим обходит списки смежности исходного графа через фильтры, Краскал собирает из них только массив
+     * ребер для сортировки; обоим нужна лишь перенумерация оставленных вершин за O(V). Filter-Kruskal и Борувка
+     * работают по снимку Freeze(), то есть сначала копируют подграф за O(V+E)
+     */
+    ResultGraph FindMST(MstAlgorithm algorithm, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+private:
+    size_t vertexCount() const {
+        if constexpr (std::is_same_v<Graph, ResultGraph>) {
+            return this->graph->vertex->size();
+        } else {
+            return this->graph->vertex.size();
+        }
+    }
+    VertexId id(size_t ind) const {
+        if constexpr (std::is_same_v<Graph, ResultGraph>) {
+            return (*this->graph->vertex)[ind];
+        } else {
+            return this->graph->vertex[ind];
+        }
+    }
+    bool keeps(size_t ind) const {
+        return this->vertex_mask.empty() || this->vertex_mask[ind];
+    }
+    // количество полуребер вершины ind в исходном графе, без фильтра ребер
+    size_t halfCount(size_t ind) const {
+        if constexpr (std::is_same_v<Graph, ResultGraph>) {
+            return this->graph->edge[ind].size();
+        } else {
+            return this->graph->offset[ind + 1] - this->graph->offset[ind];
+        }
+    }
+    // индекс оставленной вершины в исходном графе или HashIndex::kNotFound
+    uint32_t find(const VertexId& v_num) const noexcept;
+    // ребро подграфа между вершинами с весом из исходного графа, если оно есть и прошло фильтр
+    std::optional<Edge> findEdge(const VertexId& from_v, const VertexId& to_v) const;
+    // вызывает f(индекс соседа, ребро) для каждого оставленного полуребра вершины ind, включая петли;
+    // определена здесь, а не в subgraph_view.cpp, потому что ее обходят и алгоритмы остовного дерева в findMST.cpp
+    template <class F>
+    void forEachHalf(size_t ind, F&& f) const {
+        VertexId from_v = this->id(ind);
+        auto visit = [&](uint32_t to, const auto&... weight) {
+            if (!this->keeps(to)) {
+                return;
+            }
+            VertexId to_v = this->id(to);
+            Edge e(std::min(from_v, to_v), std::max(from_v, to_v), weight...);
+            if (!this->edge_filter || this->edge_filter(e)) {
+                f(to, e);
+            }
+        };
+
+        if constexpr (std::is_same_v<Graph, ResultGraph>) {
+            for (auto& half : this->graph->edge[ind]) {
+                if constexpr (std::is_void_v<Weight>) {
+                    visit(half.to);
+                } else {
+                    visit(half.to, half.weight);
+                }
+            }
+        } else {
+            for (size_t k = this->graph->offset[ind]; k < this->graph->offset[ind + 1]; k++) {
+                if constexpr (std::is_void_v<Weight>) {
+                    visit(this->graph->neighbor[k]);
+                } else {
+                    visit(this->graph->neighbor[k], this->graph->weight[k]);
+                }
+            }
+        }
+    }
+
+    const Graph* graph;
+    std::vector<bool> vertex_mask;
+    size_t vertex_count;
+    EdgeFilter edge_filter;
+    HashIndex<VertexId> frozen_index;
+};
+
+#endif
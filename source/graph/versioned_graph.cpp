@@ -0,0 +1,28 @@
+#include "versioned_graph.h"
+
+template <class VertexId, class Weight>
+BasicVersionedGraph<VertexId, Weight>::BasicVersionedGraph(Graph graph) : working(std::move(graph)) {
+    this->Commit();
+}
+
+template <class VertexId, class Weight>
+typename BasicVersionedGraph<VertexId, Weight>::Snapshot BasicVersionedGraph<VertexId, Weight>::Acquire() const {
+    return Snapshot(this->published.Load());
+}
+
+template <class VertexId, class Weight>
+BasicGraph<VertexId, Weight>& BasicVersionedGraph<VertexId, Weight>::Writer() noexcept {
+    return this->working;
+}
+
+template <class VertexId, class Weight>
+uint64_t BasicVersionedGraph<VertexId, Weight>::Commit() {
+    std::pmr::memory_resource* resource = this->working.Resource();
+    // копия разделяет с рабочим графом все куски: следующие изменения писателя скопируют только то, что тронут
+    this->published.Store(detail::MakeShared<Entry>(resource, this->working, resource, this->version));
+    return this->version++;
+}
+
+#define INSTANTIATE(VertexId, Weight) template class BasicVersionedGraph<VertexId, Weight>;
+GRAPH_FOR_EACH_INSTANCE(INSTANTIATE)
+#undef INSTANTIATE
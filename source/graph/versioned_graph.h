@@ -0,0 +1,103 @@
+#ifndef GRAPH_VERSIONED_GRAPH_H
+#define GRAPH_VERSIONED_GRAPH_H
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+#include "cow.h"
+#include "graph.h"
+
+
+/*!
+    \brief Класс BasicVersionedGraph - граф с версиями для одного писателя и многих читателей (MVCC).
+    \details Писатель меняет рабочую копию графа через Writer() и публикует ее вызовом Commit(). Каждая
+    опубликованная версия неизменяема; читатель берет ее вызовом Acquire() за O(1) без мьютексов (см. PublishedPtr),
+    не блокируя писателя, и работает с ней сколько угодно (FindMST, обходы), не видя следующих изменений. Версия
+    освобождается, когда отпущен последний ее Snapshot и опубликована следующая версия.
+    Версии не копируют списки смежности: Commit делает copy-on-write копию рабочего графа за O(V / 256), и версии
+    разделяют с рабочей копией и друг с другом все куски, которые писатель с тех пор не трогал.
+    * published - последняя опубликованная версия
+    * working - рабочая копия писателя
+    * version - номер следующей версии
+*/
+template <class VertexId, class Weight>
+class BasicVersionedGraph {
+public:
+    using Graph = BasicGraph<VertexId, Weight>;
+
+    /*!
+        \brief Опубликованная версия графа, которую держит читатель
+    */
+    class Snapshot {
+    public:
+        Snapshot() = default;
+
+        const Graph& operator*() const noexcept {
+            return this->entry->graph;
+        }
+        const Graph* operator->() const noexcept {
+            return &this->entry->graph;
+        }
+        /*!
+         * @return Номер версии; версии нумеруются с нуля в порядке публикации
+         */
+        uint64_t Version() const noexcept {
+            return this->entry->version;
+        }
+        explicit operator bool() const noexcept {
+            return this->entry != nullptr;
+        }
+
+    private:
+        friend class BasicVersionedGraph;
+
+        struct Entry {
+            Graph graph;
+            uint64_t version;
+
+            Entry(const Graph& graph, std::pmr::memory_resource* resource, uint64_t version)
+                : graph(graph, resource), version(version) {}
+        };
+
+        explicit Snapshot(std::shared_ptr<const Entry> entry) : entry(std::move(entry)) {}
+
+        std::shared_ptr<const Entry> entry;
+    };
+
+    /*!
+     * Создает граф с версиями и публикует версию 0
+     * @param graph исходный граф; его источник памяти используется для всех версий
+     */
+    explicit BasicVersionedGraph(Graph graph = Graph());
+
+    BasicVersionedGraph(const BasicVersionedGraph&) = delete;
+    BasicVersionedGraph& operator=(const BasicVersionedGraph&) = delete;
+
+    /*!
+     * Берет последнюю опубликованную версию. Можно вызывать из любого потока
+     * @return Неизменяемая версия графа за O(1), без копирования графа
+     */
+    Snapshot Acquire() const;
+    /*!
+     * Рабочая копия графа. Менять ее может только один поток-писатель; читатели изменений не видят до Commit
+     * @return Рабочая копия
+     */
+    Graph& Writer() noexcept;
+    /*!
+     * Публикует текущее состояние рабочей копии. Вызывается из потока-писателя
+     * @return Номер опубликованной версии
+     */
+    uint64_t Commit();
+
+private:
+    using Entry = typename Snapshot::Entry;
+
+    detail::PublishedPtr<Entry> published;
+    Graph working;
+    uint64_t version = 0;
+};
+
+using VersionedGraph = BasicVersionedGraph<int, int>;
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef GRAPH_WEIGHT_INDEX_H
+#define GRAPH_WEIGHT_INDEX_H
+
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <utility>
+
+#include "cow.h"
+
+
+namespace detail {
+
+/*!
+    \brief Запись индекса весов - ребро, упорядоченное по весу, а при равных весах по номерам вершин.
+    \details Хранятся номера вершин, а не внутренние индексы: номера не меняются, когда RemoveVertex переставляет
+    вершины, поэтому индекс не нужно перенумеровывать.
+    * weight - вес ребра
+    * from - меньшая вершина ребра
+    * to - большая вершина ребра
+*/
+template <class VertexId, class Weight>
+struct WeightKey {
+    Weight weight;
+    VertexId from;
+    VertexId to;
+
+    // наименьшая запись с весом weight: с нее начинается поиск ребер веса не меньше weight
+    static WeightKey Lowest(const Weight& weight) {
+        return {weight, std::numeric_limits<VertexId>::lowest(), std::numeric_limits<VertexId>::lowest()};
+    }
+
+    bool operator<(const WeightKey& other) const {
+        if (this->weight < other.weight || other.weight < this->weight) {
+            return this->weight < other.weight;
+        }
+        return this->from < other.from || (this->from == other.from && this->to < other.to);
+    }
+};
+
+/*!
+    \brief Индекс весов графа: все ребра, упорядоченные по WeightKey. Вставка и удаление ребра за O(log E),
+    поиск первого ребра с весом не меньше заданного за O(log E), дальше ребра идут по возрастанию веса.
+*/
+template <class VertexId, class Weight>
+using WeightIndex = std::pmr::set<WeightKey<VertexId, Weight>>;
+
+/*!
+    \brief Класс LazyWeightIndex - индекс весов версии графа, который строится лениво и никогда не копируется.
+    \details Индекс выводится из ребер графа, поэтому его можно не копировать, а построить заново. Копия графа разделяет
+    индекс с оригиналом за O(1), пока обе копии его только читают. Копия, которая меняет ребро, правит индекс на месте,
+    только если держит его одна; разделяемый индекс она просто отпускает, а не копирует за O(E). Версия без индекса
+    строит свой заново при первом запросе по весу (см. LazyCache), и запросы нескольких потоков не блокируют друг друга.
+    Правила ресурсов такие же, как у CowPtr, только при разных ресурсах индекс не копируется, а тоже строится заново.
+    * cache - индекс или пусто, если его еще не построили или отпустили
+    * resource - откуда берется память индекса
+*/
+template <class VertexId, class Weight>
+class LazyWeightIndex {
+public:
+    using Index = WeightIndex<VertexId, Weight>;
+
+    explicit LazyWeightIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+        : resource(resource) {}
+    LazyWeightIndex(const LazyWeightIndex& other, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : resource(resource) {
+        this->share(other);
+    }
+    LazyWeightIndex(LazyWeightIndex&& other) noexcept : cache(std::move(other.cache)), resource(other.resource) {}
+    LazyWeightIndex& operator=(const LazyWeightIndex& other) {
+        if (this != &other) {
+            this->share(other);
+        }
+        return *this;
+    }
+    LazyWeightIndex& operator=(LazyWeightIndex&& other) noexcept {
+        if (this != &other) {
+            if (this->resource->is_equal(*other.resource)) {
+                this->cache = std::move(other.cache);
+            } else {
+                this->cache.Reset();
+                other.cache.Reset();
+            }
+        }
+        return *this;
+    }
+
+    /*!
+     * @return Построенный индекс или nullptr
+     */
+    std::shared_ptr<const Index> Get() const {
+        return this->cache.Get();
+    }
+    /*!
+     * Индекс для запроса: если его нет, он строится вызовом build() и публикуется; можно вызывать из нескольких потоков
+     * @param build функция, которая заполняет пустой индекс всеми ребрами графа
+     */
+    template <class Fill>
+    std::shared_ptr<const Index> Build(Fill&& build) const {
+        std::shared_ptr<Index> index = this->cache.Get();
+        if (index) {
+            return index;
+        }
+        index = MakeShared<Index>(this->resource, this->resource);
+        build(*index);
+        return this->cache.Publish(std::move(index));
+    }
+    /*!
+     * @return Индекс, который можно менять на месте, или nullptr, если его нет или его разделяет другая копия графа
+     */
+    Index* Exclusive() {
+        return this->cache.Exclusive();
+    }
+    // отпускает индекс; следующий запрос построит его заново
+    void Reset() noexcept {
+        this->cache.Reset();
+    }
+
+private:
+    void share(const LazyWeightIndex& other) {
+        if (this->resource->is_equal(*other.resource)) {
+            this->cache = other.cache;
+        } else {
+            this->cache.Reset();
+        }
+    }
+
+    LazyCache<Index> cache;
+    std::pmr::memory_resource* resource;
+};
+
+// место индекса весов у невзвешенного графа: индекса нет, но конструкторы графа одинаковы для всех Weight
+struct NoWeightIndex {
+    NoWeightIndex() = default;
+    explicit NoWeightIndex(std::pmr::memory_resource*) noexcept {}
+    NoWeightIndex(const NoWeightIndex&, std::pmr::memory_resource*) noexcept {}
+    NoWeightIndex(const NoWeightIndex&) = default;
+    NoWeightIndex& operator=(const NoWeightIndex&) = default;
+};
+
+}
+
+#endif